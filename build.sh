@@ -10,6 +10,7 @@
 #   USE_NVML:            ON/OFF (default: ON)
 #   USE_SENTENCEPIECE:   ON/OFF (default: ON)
 #   USE_TOKENIZERS:      ON/OFF (default: OFF)
+#   EAPO_TRACE:          ON/OFF (default: OFF)
 # =============================================================================
 
 LIBTORCH_DIR="${LIBTORCH_DIR:-$HOME/libs/libtorch}"
@@ -17,6 +18,7 @@ BUILD_DIR="${BUILD_DIR:-build}"
 USE_NVML="${USE_NVML:-ON}"
 USE_SENTENCEPIECE="${USE_SENTENCEPIECE:-ON}"
 USE_TOKENIZERS="${USE_TOKENIZERS:-OFF}"
+EAPO_TRACE="${EAPO_TRACE:-OFF}"
 
 echo "=== EAPO_Cpp Build & Make Script ==="
 echo "  LibTorch:           $LIBTORCH_DIR"
@@ -24,6 +26,7 @@ echo "  Build Directory:    $BUILD_DIR"
 echo "  Use NVML:           $USE_NVML"
 echo "  Use SentencePiece:  $USE_SENTENCEPIECE"
 echo "  Use Tokenizers:     $USE_TOKENIZERS"
+echo "  Tracing:            $EAPO_TRACE"
 echo
 
 set -e
@@ -39,6 +42,7 @@ cmake .. \
   -DUSE_NVML=$USE_NVML \
   -DUSE_SENTENCEPIECE=$USE_SENTENCEPIECE \
   -DUSE_TOKENIZERS=$USE_TOKENIZERS \
+  -DEAPO_TRACE=$EAPO_TRACE \
   -DCMAKE_BUILD_TYPE=Release
 
 # Build all targets
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// Process-wide count of global operator new calls.
+//
+// alloc_counter.cpp replaces the global operator new/delete with thin
+// malloc/free wrappers that bump a relaxed atomic counter, so a region's
+// heap allocations are the difference of two count() readings. Memory
+// obtained through other allocators (e.g. LibTorch tensor storage, which
+// uses posix_memalign) is not included; tensor and IValue objects are.
+namespace alloc {
+
+uint64_t count();
+
+} // namespace alloc
@@ -1,10 +1,13 @@
 // ===== src/config.hpp =====
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <map>
 #include <vector>
 
+#include "decoding.hpp"
+
 // Config struct: loads JSON configuration
 // from a file using nlohmann::json
 struct Config {
@@ -13,6 +16,33 @@ struct Config {
     std::string dataset_path;
     std::string results_dir;
     int num_trials;
+    // Generation limits and default stopping criteria
+    int max_new_tokens = 50;
+    std::vector<int64_t> eos_ids;          // empty: use the tokenizer's EOS
+    std::vector<std::string> stop_strings;
+    // Context window management (0 = unlimited)
+    int context_length = 0;
+    std::string context_policy = "keep_head"; // keep_head | keep_tail | sliding_window
+    int prefill_chunk = 512;                   // tokens per prefill chunk (cached models)
+    // Collect hardware counters (Linux perf_event_open) per generation
+    bool perf_counters = false;
+    // Measurement protocol for latency/energy
+    struct Measurement {
+        int warmup_examples = 0;              // leading examples run but not measured
+        int repetitions = 1;                  // timed runs per example or per trial
+        std::string repeat_mode = "example";  // "example" | "trial"
+        double mad_threshold = 3.5;           // outlier cut-off (modified z-score, 0 = off)
+        int bootstrap_samples = 1000;         // resamples for confidence intervals
+        double confidence = 0.95;             // confidence level of the intervals
+        uint64_t seed = 42;                   // bootstrap RNG seed
+    } measurement;
+    // Default decoding strategy; prompt configs override it
+    DecodingSpec decoding;
+    // Decoding search dimensions, combined with prompt_space in search.
+    // Keys are DecodingSpec::keys() plus max_new_tokens; JSON numbers are
+    // kept as their text (e.g. {"temperature": [0.7, 1.0]}). Every value
+    // is validated on load.
+    std::map<std::string, std::vector<std::string>> decoding_space;
     // Prompt space definitions
     std::map<std::string, std::vector<std::string>> prompt_space;
 
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tokenizer.hpp"
+
+// How to make a prompt fit the model's context window
+enum class ContextPolicy {
+    KeepHead,      // drop the end of the document
+    KeepTail,      // drop the start of the document
+    SlidingWindow  // keep the full prompt; the model sees only the last N tokens
+};
+
+// Parse "keep_head", "keep_tail" or "sliding_window"; throws on anything else
+ContextPolicy parseContextPolicy(const std::string &name);
+
+// A rendered, tokenized prompt that fits the context budget
+struct FittedPrompt {
+    std::string prompt;
+    std::vector<int> ids;
+    int truncated_tokens = 0;  // document tokens removed to fit
+};
+
+// ContextManager: renders prompts and truncates the document (never the
+// instruction) so that prompt + max_new_tokens fits in context_length.
+// A context_length of 0 disables truncation.
+class ContextManager {
+public:
+    ContextManager(const Tokenizer &tokenizer,
+                   int context_length,
+                   ContextPolicy policy);
+
+    // Writes into `out`, reusing its string/ID storage across examples
+    void fit(const std::string &doc,
+             const std::map<std::string, std::string> &cfg,
+             int max_new_tokens,
+             FittedPrompt &out) const;
+
+    int contextLength() const { return context_length_; }
+    ContextPolicy policy() const { return policy_; }
+
+private:
+    void render(const std::string &doc,
+                const std::map<std::string, std::string> &cfg,
+                FittedPrompt &out) const;
+
+    const Tokenizer &tokenizer_;
+    int context_length_;
+    ContextPolicy policy_;
+};
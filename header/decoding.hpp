@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Decoding parameters; selectable per prompt config and searchable via
+// the config's "decoding_space".
+struct DecodingSpec {
+    std::string strategy = "greedy";  // "greedy" | "sample"
+    float temperature = 1.0f;         // sample only; <= 0 means greedy
+    int top_k = 0;                    // 0 = no top-k filter
+    float top_p = 1.0f;               // 1 = no nucleus filter
+    float repetition_penalty = 1.0f;  // 1 = off (CTRL-style penalty)
+    int min_new_tokens = 0;           // EOS is masked until this many tokens
+    uint64_t seed = 0;                // base seed; mixed with the sequence id
+
+    // Override fields from prompt config keys of the same name; throws
+    // std::invalid_argument on values that are not numbers
+    static DecodingSpec fromPromptConfig(const std::map<std::string, std::string> &cfg,
+                                         const DecodingSpec &base);
+
+    // Keys fromPromptConfig understands (also the valid decoding_space axes)
+    static const std::vector<std::string> &keys();
+
+    // Throws std::invalid_argument for an unknown strategy or an
+    // out-of-range parameter
+    void validate() const;
+};
+
+// Sampler: picks the next token from the last-step logits.
+//
+// All processing (EOS masking, repetition penalty, temperature, top-k,
+// top-p, draw) happens in place on a contiguous float buffer in a few
+// linear passes. Top-k/top-p use nth_element/partial_sort over scratch
+// indices instead of sorting the vocabulary. Each sequence gets its own
+// RNG stream derived from (seed, sequence id), so results don't depend
+// on evaluation order or repetitions.
+class Sampler {
+public:
+    Sampler(DecodingSpec spec, std::vector<int64_t> eos_ids);
+
+    // True when next() reduces to plain argmax, so callers can skip
+    // moving logits to the host
+    bool isGreedy() const { return greedy_ && spec_.repetition_penalty == 1.0f
+                                   && spec_.min_new_tokens == 0; }
+
+    // Start a new sequence: reseed and forget seen tokens
+    void reset(uint64_t sequence_id);
+
+    // Mark tokens as seen for the repetition penalty (e.g. the prompt)
+    void observe(const std::vector<int> &ids);
+    void observe(int64_t id);
+
+    // Choose the next token; `logits` [vocab] is modified in place.
+    // The chosen token is observed automatically.
+    int64_t next(float *logits, int64_t vocab, int num_generated);
+
+    const DecodingSpec &spec() const { return spec_; }
+
+private:
+    int64_t argmax(const float *logits, int64_t vocab) const;
+    int64_t sample(float *logits, int64_t vocab);
+
+    DecodingSpec spec_;
+    std::vector<int64_t> eos_ids_;
+    bool greedy_;
+    std::mt19937_64 rng_;
+
+    // Scratch reused across steps
+    std::vector<uint8_t> seen_;       // bitmap over vocab
+    std::vector<int64_t> seen_ids_;   // set bits, for sparse penalty/reset
+    std::vector<int32_t> idx_;        // candidate indices
+};
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 #include <nlohmann/json.hpp>
 #ifdef USE_NVML
 #include <nvml.h>
@@ -11,6 +14,11 @@
 #include "config.hpp"
 #include "metrics.hpp"
 #include "prompts.hpp"
+#include "context.hpp"
+#include "perf_counters.hpp"
+#include "stopping.hpp"
+#include "decoding.hpp"
+#include "stats.hpp"
 
 /**
  * Evaluator: runs inference over a JSONL dataset, logs energy & latency,
@@ -25,7 +33,10 @@ public:
 
     /**
      * Run detailed evaluation for a given prompt config.
-     * Writes per-example CSV (`eval_per_example.csv`) under `results_dir`.
+     * Writes per-example CSV (`eval_per_example.csv`) and run metadata
+     * (`run_metadata.json`) under `results_dir`. Rows are per example, so
+     * each example is always repeated back to back (as in
+     * `repeat_mode: "example"`) regardless of measurement.repeat_mode.
      */
     void run(const std::string &prompt_cfg_json,
              const std::string &dataset_path,
@@ -36,7 +47,25 @@ public:
         double rougeL;         ///< average Rouge-L F1 score
         double energyTotalJ;   ///< total energy consumed (J)
         double latencyS;       ///< total latency (seconds)
+        stats::Interval rougeLCI;  ///< CI of rougeL over documents (spread, not noise)
+        stats::Interval energyCI;  ///< CI of energyTotalJ from repetition noise
+        stats::Interval latencyCI; ///< CI of latencyS from repetition noise
+        size_t rejectedSamples;    ///< repetitions (or passes) dropped as latency outliers
         double tokensPerJoule; ///< tokens generated per joule
+        double avgNewTokens;   ///< mean new tokens per example (after early stop)
+
+        /// Hardware counters summed over all generations (NaN if unavailable)
+        PerfCounts perfTotal;
+        /// perfTotal divided by generated tokens / by number of examples
+        PerfCounts perfPerToken;
+        PerfCounts perfPerExample;
+
+        double avgTruncatedTokens; ///< mean prompt/context tokens dropped per example
+        double peakRssMB;          ///< max per-example peak RSS (MB)
+        double allocsPerExample;   ///< mean heap allocations per example
+        double allocsPerToken;     ///< heap allocations in generate per new token
+        double forwardAllocsPerToken; ///< ... of which in TorchScript forward calls
+        double loopAllocsPerToken;    ///< decode loop alone, per step (prefill excluded)
     };
 
     /**
@@ -44,8 +73,84 @@ public:
      */
     SummaryMetrics evaluateSummary(const std::string &prompt_cfg_json);
 
+    /**
+     * Write run metadata (thread counts, CPU governors/frequencies,
+     * measurement protocol) as JSON to `path`.
+     */
+    void writeRunMetadata(const std::string &path) const;
+
 private:
+    /// Outcome of generating for a single document. Also serves as the
+    /// per-example scratch arena: callers reuse one instance so prompt,
+    /// token and text buffers keep their capacity between examples.
+    struct ExampleResult {
+        FittedPrompt     fitted;   ///< rendered prompt and its token IDs
+        GenerationResult gen;      ///< generated text and stop reason
+        double           latencyS; ///< generation latency (seconds)
+        double           energyJ;  ///< estimated energy (J)
+        PerfCounts       perf;     ///< hardware counters around generation
+        int              truncatedTokens; ///< tokens dropped to fit the context
+        double           peakRssMB;       ///< peak RSS during the example (MB)
+        double           rougeL = 0.0;    ///< Rouge-L vs. the reference
+        double           latencyMadS = 0.0; ///< MAD of latency over repetitions
+        int              repsKept = 1;      ///< repetitions left after rejection
+        size_t           rejected = 0;      ///< repetitions dropped as outliers
+        std::vector<double> keptLatencyS;   ///< latency of kept repetitions
+        std::vector<double> keptEnergyJ;    ///< energy of kept repetitions
+        uint64_t         allocs = 0;        ///< heap allocations for the example
+        uint64_t         generateAllocs = 0; ///< ... of which inside generate
+    };
+
+    /// One dataset record
+    struct Record {
+        uint64_t    id;   ///< line index; seeds the per-sequence sampler RNG
+        std::string doc;
+        std::string ref;
+    };
+
+    /// Per-run decoding state derived from the prompt config
+    struct Decoder {
+        StoppingCriteria criteria;
+        Sampler          sampler;
+    };
+
+    /// Stopping criteria (e.g. from brevity) and sampler for a prompt config
+    Decoder makeDecoder(const std::map<std::string, std::string> &cfg_map) const;
+
+    /// Load the JSONL dataset into memory
+    static std::vector<Record> loadDataset(const std::string &dataset_path);
+
+    /// Flatten prompt config JSON into the map PromptGenerator expects
+    static std::map<std::string, std::string>
+    parsePromptConfig(const std::string &prompt_cfg_json);
+
+    /// Render, tokenize and generate for one document, timing the generation
+    void runExample(const Record &rec,
+                    const std::map<std::string, std::string> &cfg_map,
+                    Decoder &dec,
+                    ExampleResult &ex);
+
+    /// runExample repeated `repetitions` times; latency/energy
+    /// are robust medians over the kept repetitions, the rest comes from
+    /// the first repetition. Also scores Rouge-L against `rec.ref`.
+    void measureExample(const Record &rec,
+                        const std::map<std::string, std::string> &cfg_map,
+                        Decoder &dec,
+                        int repetitions,
+                        ExampleResult &ex);
+
+    /// Run the configured warmup examples; returns how many were used
+    size_t warmup(const std::vector<Record> &records,
+                  const std::map<std::string, std::string> &cfg_map,
+                  Decoder &dec);
+
     const Tokenizer &tokenizer_;  ///< tokenizer for encode/decode
     Model           &model_;      ///< model for generation
     Config           config_;     ///< configuration (paths, prompt space)
+    StoppingCriteria::Spec baseStop_; ///< default stopping criteria from config
+    std::unique_ptr<PerfCounterGroup> perf_; ///< set when config enables counters
+    ContextManager   context_;    ///< fits prompts into the context window
+    ExampleResult    repScratch_; ///< scratch for extra timing repetitions
+    bool             rssWarned_ = false; ///< peak-RSS reset failure reported
+    std::vector<double> repLatency_, repEnergy_; ///< per-repetition samples
 };
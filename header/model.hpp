@@ -6,21 +6,93 @@
 #include <new>
 #include <torch/script.h>
 
+#include "stopping.hpp"
+#include "decoding.hpp"
+
+// Output of one generation call
+struct GenerationResult {
+    std::string text;                // generated continuation only
+    int prompt_tokens = 0;           // input prefix length
+    int num_generated = 0;           // new tokens produced (EOS excluded)
+    int truncated_tokens = 0;        // tokens that slid out of the context window
+    StopReason stop_reason = StopReason::None;
+
+    // Heap allocations (see alloc_counter.hpp), split so the interpreter
+    // doesn't hide the loop's own cost
+    uint64_t forward_allocs = 0;     // inside TorchScript forward calls
+    uint64_t loop_allocs = 0;        // decode loop outside forward calls
+    int loop_steps = 0;              // decode iterations behind loop_allocs
+};
+
 // Wrapper around a TorchScript causal language model for generation
+//
+// The module's forward(ids [1, seq_len]) -> logits [1, seq_len, vocab] is
+// always supported. If the module also exports
+//     forward_cached(ids [1, n], past: Optional[Any]) -> (logits, past)
+// the prompt is prefilled in fixed-size chunks and each decode step feeds
+// only the new token, which bounds peak activation memory for long inputs.
+// See README.md ("Chunked prefill") for the exact TorchScript signature.
+//
+// The decode loop keeps per-token allocations small but not at zero.
+// Tokens go into a preallocated [1, max_len] buffer, and the argmax output
+// and interpreter stack are reused between steps. Each step still creates
+// a few tensor views (narrow/select heap-allocate a TensorImpl), and
+// SentencePiece allocates while detokenizing. GenerationResult reports
+// these loop allocations separately from the TorchScript forward calls.
 class Model {
 public:
     // Load a serialized TorchScript model (.pt)
     explicit Model(const std::string &model_path);
 
-    // Generate output token IDs given input IDs
-    // - input_ids: vector of token IDs (1D)
-    // - max_new_tokens: number of tokens to generate beyond inputs
-    // Returns: full sequence of output token IDs (including input prefix)
-    std::vector<int64_t> generate(
-        const std::vector<int64_t> &input_ids,
-        int max_new_tokens = 50
+    // Generate given input IDs, writing into `result` (reuses its storage)
+    // - input_ids: prompt token IDs as produced by the tokenizer
+    // - criteria: stopping criteria, consulted after every new token
+    //   (EOS, stop strings, sentence/word limits, token budget)
+    // - sampler: decoding strategy; the caller resets it per sequence
+    void generate(
+        const std::vector<int> &input_ids,
+        StoppingCriteria &criteria,
+        Sampler &sampler,
+        GenerationResult &result
     );
 
+    // Max tokens the model sees per forward (0 = unbounded). Longer
+    // sequences are windowed to their most recent tokens.
+    void setContextWindow(int tokens) { context_window_ = tokens; }
+
+    // Prefill chunk size for forward_cached (0 = whole prompt at once)
+    void setPrefillChunk(int tokens) { prefill_chunk_ = tokens; }
+
 private:
+    // KV-cache state threaded through forward_cached
+    struct CacheState {
+        torch::jit::IValue past;  // None before the first chunk
+        int64_t length = 0;       // tokens held in the cache
+    };
+
+    // Last-step logits [1, vocab] after running the full (windowed) sequence
+    at::Tensor forwardFull(const torch::Tensor &ids);
+    // Last-step logits after prefilling `ids` into a fresh cache
+    at::Tensor prefill(const torch::Tensor &ids, CacheState &cache);
+    // Last-step logits after appending one token; `ids` is the full sequence
+    at::Tensor step(const torch::Tensor &ids, const torch::Tensor &next, CacheState &cache);
+    // Run forward_cached on `ids`, updating the cache; returns logits
+    at::Tensor forwardCached(const torch::Tensor &ids, CacheState &cache);
+    // Most recent context_window_ tokens of `ids`
+    torch::Tensor windowed(const torch::Tensor &ids) const;
+    // Grow the token buffer to hold at least `len` tokens
+    void reserveTokens(int64_t len);
+
     torch::jit::script::Module module_;
-};
\ No newline at end of file
+    c10::optional<torch::jit::Method> forward_;  // module forward
+    c10::optional<torch::jit::Method> cached_;   // forward_cached, if exported
+    torch::Device device_ = torch::kCPU;
+    int context_window_ = 0;
+    int prefill_chunk_ = 512;
+
+    // Reused across steps and calls
+    torch::Tensor tokens_;          // [1, capacity] int64 token buffer
+    torch::Tensor argmax_;          // 0-dim int64 argmax output
+    torch::jit::Stack stack_;       // interpreter stack
+    uint64_t forward_allocs_ = 0;   // allocations inside forward calls
+};
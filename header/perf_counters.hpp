@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hardware counter readings for one measured region.
+// Fields are NaN when the counter could not be read.
+struct PerfCounts {
+    double cycles       = 0.0;
+    double instructions = 0.0;
+    double llcMisses    = 0.0;  ///< last-level cache misses
+    double branchMisses = 0.0;
+
+    PerfCounts &operator+=(const PerfCounts &o) {
+        cycles       += o.cycles;
+        instructions += o.instructions;
+        llcMisses    += o.llcMisses;
+        branchMisses += o.branchMisses;
+        return *this;
+    }
+
+    static PerfCounts unavailable();
+};
+
+// PerfCounterGroup: Linux perf_event_open counters (cycles, instructions,
+// LLC misses, branch misses) for every thread of the process, user space
+// only. One counter group is opened per thread; sync() rescans
+// /proc/self/task so threads created since (e.g. LibTorch's intra-op
+// pool, which starts lazily) are picked up, and stop() sums all groups.
+// sync() reads /proc, allocates and opens fds, so call it outside any
+// timed region; start()/stop() are only ioctls and reads.
+//
+// Opening never throws: if perf events are unsupported or locked down
+// (e.g. perf_event_paranoid in containers), available() returns false,
+// reason() says why, and stop() returns PerfCounts::unavailable().
+// Counts are scaled for multiplexing using time enabled/running.
+class PerfCounterGroup {
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+    PerfCounterGroup(const PerfCounterGroup &) = delete;
+    PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+    bool available() const { return leader_fd_ >= 0; }
+    const std::string &reason() const { return reason_; }
+
+    // Open groups for new threads and close those of exited threads
+    void sync();
+    // Reset and enable every group
+    void start();
+    // Disable the groups and return counts since start(), summed over
+    // threads; unavailable() if any live thread could not be counted
+    PerfCounts stop();
+
+    // Threads counted since the last sync()
+    size_t threads() const { return threads_.size(); }
+
+private:
+    static constexpr int kNumCounters = 4;
+
+    // Counter group for one thread
+    struct ThreadGroup {
+        int tid;
+        int fds[kNumCounters];
+    };
+
+    // Open a group for `tid`; on failure sets reason_ and returns false
+    bool open(int tid, ThreadGroup &group);
+
+    int leader_fd_ = -1;  // calling thread's leader; -1 if unsupported
+    std::vector<ThreadGroup> threads_;
+    bool complete_ = true;  // every live thread has a group
+    std::string reason_;
+};
@@ -2,8 +2,6 @@
 
 #include <string>
 #include <map>
-#include <vector>
-#include <sstream>
 
 // PromptGenerator: builds instruction prompts based on configuration
 // cfg keys: "style", "reasoning", "format", "brevity"
@@ -15,67 +13,77 @@ public:
         const std::string &doc,
         const std::map<std::string, std::string> &cfg
     ) {
-        std::vector<std::string> fragments;
-        auto get = [&](const std::string &key) {
+        std::string prompt;
+        renderPrompt(doc, cfg, prompt);
+        return prompt;
+    }
+
+    // Render into `out`, reusing its capacity (at most one fragment per key,
+    // so fragments live in a fixed array rather than a vector)
+    static void renderPrompt(
+        const std::string &doc,
+        const std::map<std::string, std::string> &cfg,
+        std::string &out
+    ) {
+        static const std::string kEmpty;
+        const char *fragments[4];
+        size_t n = 0;
+        auto get = [&](const std::string &key) -> const std::string & {
             auto it = cfg.find(key);
-            return it != cfg.end() ? it->second : std::string();
+            return it != cfg.end() ? it->second : kEmpty;
         };
-        std::string style     = get("style");
-        std::string reasoning = get("reasoning");
-        std::string fmt       = get("format");
-        std::string brevity   = get("brevity");
+        const std::string &style     = get("style");
+        const std::string &reasoning = get("reasoning");
+        const std::string &fmt       = get("format");
+        const std::string &brevity   = get("brevity");
 
         // Style instructions
         if (style == "concise") {
-            fragments.push_back("Please summarize the following text.");
+            fragments[n++] = "Please summarize the following text.";
         } else if (style == "role") {
-            fragments.push_back("You are a summarization expert. Please summarize.");
+            fragments[n++] = "You are a summarization expert. Please summarize.";
         } else if (style == "stepwise") {
-            fragments.push_back("Summarize step by step:");
+            fragments[n++] = "Summarize step by step:";
         } else if (style == "few-shot") {
-            fragments.push_back("Example:\nText: ... Summary: ...\nNow you: summarize the following text.");
+            fragments[n++] = "Example:\nText: ... Summary: ...\nNow you: summarize the following text.";
         } else if (style == "chain-of-thought") {
-            fragments.push_back("Think step by step, then summarize:");
+            fragments[n++] = "Think step by step, then summarize:";
         }
         // Reasoning cues
         if (reasoning == "brief") {
-            fragments.push_back("Provide a brief rationale.");
+            fragments[n++] = "Provide a brief rationale.";
         } else if (reasoning == "bounded") {
-            fragments.push_back("Explain concisely why you chose this summary.");
+            fragments[n++] = "Explain concisely why you chose this summary.";
         } else if (reasoning == "detailed") {
-            fragments.push_back("Provide a detailed explanation of your reasoning.");
+            fragments[n++] = "Provide a detailed explanation of your reasoning.";
         }
         // Format directives
         if (fmt == "bullets") {
-            fragments.push_back("Use bullet points.");
+            fragments[n++] = "Use bullet points.";
         } else if (fmt == "json") {
-            fragments.push_back("Output in valid JSON format.");
+            fragments[n++] = "Output in valid JSON format.";
         } else if (fmt == "table") {
-            fragments.push_back("Present results in a table.");
+            fragments[n++] = "Present results in a table.";
         }
         // Brevity constraints
         if (brevity == "1sent") {
-            fragments.push_back("Limit your summary to exactly one sentence.");
+            fragments[n++] = "Limit your summary to exactly one sentence.";
         } else if (brevity == "3sent") {
-            fragments.push_back("Limit your summary to up to three sentences.");
+            fragments[n++] = "Limit your summary to up to three sentences.";
         } else if (brevity == "word50") {
-            fragments.push_back("Limit your summary to 50 words or fewer.");
+            fragments[n++] = "Limit your summary to 50 words or fewer.";
         } else if (brevity == "token50") {
-            fragments.push_back("Limit your summary to 50 tokens or fewer.");
+            fragments[n++] = "Limit your summary to 50 tokens or fewer.";
         }
 
-        // Join fragments into instruction
-        std::ostringstream instr;
-        for (size_t i = 0; i < fragments.size(); ++i) {
-            instr << fragments[i];
-            if (i + 1 < fragments.size()) instr << ' ';
+        // Join fragments into instruction, then build final prompt
+        out.clear();
+        for (size_t i = 0; i < n; ++i) {
+            out += fragments[i];
+            if (i + 1 < n) out += ' ';
         }
-
-        // Build final prompt
-        std::ostringstream prompt;
-        prompt << instr.str()
-               << "\n\nInput: " << doc
-               << "\nOutput:";
-        return prompt.str();
+        out += "\n\nInput: ";
+        out += doc;
+        out += "\nOutput:";
     }
 };
@@ -0,0 +1,46 @@
+// ===== src/stats.hpp =====
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stats {
+
+// Median of values (0 if empty)
+double median(std::vector<double> values);
+
+// Median absolute deviation around the median
+double mad(const std::vector<double> &values);
+
+// Indices of the values whose modified z-score 0.6745*|x - median|/MAD
+// is within `threshold` (3.5 is the usual cut-off), in order.
+// threshold <= 0 keeps all. Returning indices lets paired samples (e.g.
+// the energy of the same repetition) be dropped together.
+std::vector<size_t> inliersMad(const std::vector<double> &values, double threshold);
+
+// values[i] for each i in `indices`
+std::vector<double> select(const std::vector<double> &values,
+                           const std::vector<size_t> &indices);
+
+// Percentile bootstrap confidence interval
+struct Interval {
+    double low  = 0.0;
+    double high = 0.0;
+};
+
+// CI for the mean of `values`
+Interval bootstrapMeanCI(const std::vector<double> &values,
+                         size_t resamples, double confidence, uint64_t seed);
+
+// CI for the median of `values`
+Interval bootstrapMedianCI(const std::vector<double> &values,
+                           size_t resamples, double confidence, uint64_t seed);
+
+// CI for the sum over groups of each group's median, resampling within
+// every group independently (e.g. repetitions of each example). Groups
+// with a single value contribute no spread.
+Interval bootstrapSumOfMediansCI(const std::vector<std::vector<double>> &groups,
+                                 size_t resamples, double confidence, uint64_t seed);
+
+} // namespace stats
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tokenizer.hpp"
+
+// Reason a generation loop terminated
+enum class StopReason {
+    None,          // still running
+    Eos,           // produced an end-of-sequence token
+    StopString,    // generated text contains a stop string
+    SentenceCount, // reached the sentence limit
+    WordCount,     // reached the word limit
+    TokenBudget    // reached the new-token budget
+};
+
+// Short name for CSV output ("eos", "stop_string", ...)
+const char *stopReasonName(StopReason reason);
+
+// IncrementalDetokenizer: turns a stream of token IDs into text while
+// decoding only a small window of recent pieces on each step.
+// Text is emitted once it is stable, so multi-piece characters and
+// word-boundary spaces come out right without re-decoding everything.
+class IncrementalDetokenizer {
+public:
+    explicit IncrementalDetokenizer(const Tokenizer &tokenizer)
+        : tokenizer_(tokenizer) {}
+
+    // Append one token; returns how many bytes of text became visible
+    size_t push(int id);
+
+    // Emit whatever is still held back (incomplete UTF-8, pieces that
+    // decoded to nothing) so text() matches a full decode; returns bytes added
+    size_t finish();
+
+    // All text emitted so far
+    const std::string &text() const { return text_; }
+
+    // Drop everything past `size` bytes (used to cut at a stop string)
+    void truncate(size_t size) { if (size < text_.size()) text_.resize(size); }
+
+    void reset();
+
+private:
+    void decodeRange(size_t begin, size_t end, std::string &out);
+
+    const Tokenizer &tokenizer_;
+    std::vector<int> ids_;
+    // Scratch reused across steps so our buffers keep their capacity
+    // (SentencePiece still allocates internally on each decode)
+    std::vector<int> window_;
+    std::string prefix_text_;
+    std::string new_text_;
+    size_t prefix_offset_ = 0;  // start of the decode window
+    size_t read_offset_   = 0;  // end of already-emitted tokens
+    std::string text_;
+};
+
+// StoppingCriteria: decides after each generated token whether to stop.
+// Covers EOS IDs, stop strings, sentence/word limits and a token budget.
+class StoppingCriteria {
+public:
+    // Static limits; 0 means "no limit" for the count fields
+    struct Spec {
+        std::vector<int64_t> eos_ids;
+        std::vector<std::string> stop_strings;
+        int max_sentences  = 0;
+        int max_words      = 0;
+        int max_new_tokens = 50;
+
+        // Text-based checks need the detokenizer
+        bool needsText() const {
+            return !stop_strings.empty() || max_sentences > 0 || max_words > 0;
+        }
+    };
+
+    // Build a spec from the prompt config: the "brevity" axis maps to
+    // sentence/word/token limits, and optional "max_new_tokens" and
+    // "stop" keys override the defaults from `base`.
+    static Spec fromPromptConfig(const std::map<std::string, std::string> &cfg,
+                                 const Spec &base);
+
+    StoppingCriteria(const Tokenizer &tokenizer, Spec spec);
+
+    // Feed the next generated token; returns StopReason::None to continue
+    StopReason update(int64_t token_id);
+
+    // Flush held-back text once generation ends. No-op after a text
+    // limit cut the output, since anything pending lies past the cut.
+    void finish();
+
+    // Generated text so far (prompt excluded, EOS and stop string stripped)
+    const std::string &text() const { return detok_.text(); }
+
+    int numGenerated() const { return num_generated_; }
+    int maxNewTokens() const { return spec_.max_new_tokens; }
+
+    void reset();
+
+private:
+    StopReason checkText(size_t appended);
+
+    Spec spec_;
+    IncrementalDetokenizer detok_;
+    int num_generated_ = 0;
+
+    // Incremental counters over detok_.text()
+    size_t scan_pos_       = 0;
+    int sentences_         = 0;
+    int words_             = 0;
+    bool in_word_          = false;
+    bool cut_              = false;  // text truncated at a text limit
+    size_t max_stop_len_   = 0;
+};
@@ -22,14 +22,27 @@ public:
 
   std::vector<int> encode(const std::string &text) const {
     std::vector<int> ids;
-    sp_.Encode(text, &ids);
+    encode(text, ids);
     return ids;
   }
 
+  // Encode into an existing buffer (reuses its capacity)
+  void encode(const std::string &text, std::vector<int> &ids) const {
+    sp_.Encode(text, &ids);
+  }
+
   std::string decode(const std::vector<int> &ids) const {
     std::string out;
+    decode(ids, out);
+    return out;
+  }
+
+  // Decode into an existing string (reuses its capacity)
+  void decode(const std::vector<int> &ids, std::string &out) const {
     // Decode(ids, &out) is the current API
     sp_.Decode(ids, &out);
-    return out;
   }
+
+  // End-of-sequence ID, or -1 if the model defines none
+  int eosId() const { return sp_.eos_id(); }
 };
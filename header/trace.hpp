@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Lightweight per-stage tracing.
+//
+// EAPO_TRACE_SCOPE("name") records one complete event covering the rest of
+// the enclosing scope. Events go to a fixed-size thread-local buffer with
+// no locking on the hot path; trace::exportChrome() writes everything
+// recorded so far as Chrome trace-event JSON (loadable in Perfetto or
+// chrome://tracing).
+//
+// Build with -DEAPO_TRACE=ON to enable; otherwise the macros expand to
+// nothing and the functions below are empty inlines.
+//
+// Names must be string literals (only the pointer is stored).
+
+#ifdef EAPO_TRACE
+
+namespace trace {
+
+// Monotonic timestamp in nanoseconds
+int64_t nowNs();
+
+// Append a complete event to the calling thread's buffer
+void record(const char *name, int64_t begin_ns, int64_t end_ns);
+
+// Write all recorded events to `path`; returns false if the file can't be opened
+bool exportChrome(const std::string &path);
+
+// Drop all recorded events (e.g. between runs)
+void clear();
+
+// RAII scope marker
+class Scope {
+public:
+    explicit Scope(const char *name) : name_(name), begin_(nowNs()) {}
+    ~Scope() { record(name_, begin_, nowNs()); }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+private:
+    const char *name_;
+    int64_t begin_;
+};
+
+} // namespace trace
+
+#define EAPO_TRACE_CONCAT_(a, b) a##b
+#define EAPO_TRACE_CONCAT(a, b) EAPO_TRACE_CONCAT_(a, b)
+#define EAPO_TRACE_SCOPE(name) \
+    ::trace::Scope EAPO_TRACE_CONCAT(eapo_trace_scope_, __LINE__)(name)
+
+#else
+
+namespace trace {
+inline bool exportChrome(const std::string &) { return false; }
+inline void clear() {}
+} // namespace trace
+
+#define EAPO_TRACE_SCOPE(name) ((void)0)
+
+#endif
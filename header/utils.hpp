@@ -1,6 +1,8 @@
 // ===== src/utils.hpp =====
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <chrono>
@@ -17,6 +19,25 @@ std::string escapeCsv(const std::string &field);
 void writeCsv(const std::string &filepath,
               const std::vector<std::vector<std::string>> &rows);
 
+// Whole-string numeric parsing for config values (std::sto* alone accept
+// "50abc"); throws std::invalid_argument naming `key` and `value`
+int parseInt(const std::string &key, const std::string &value);
+float parseFloat(const std::string &key, const std::string &value);
+uint64_t parseUint64(const std::string &key, const std::string &value);
+
+// Peak resident set size of this process in bytes (VmHWM), 0 if unknown
+size_t peakRssBytes();
+
+// Reset the peak RSS high-water mark so the next peakRssBytes() covers
+// only what follows; returns false where unsupported (non-Linux, no /proc)
+bool resetPeakRss();
+
+// Frequency governor of each online CPU (empty where cpufreq is absent)
+std::vector<std::string> cpuGovernors();
+
+// Current frequency of each CPU in kHz (empty where cpufreq is absent)
+std::vector<long> cpuFrequenciesKHz();
+
 // Timer for measuring durations
 class Timer {
 public:
@@ -18,6 +18,30 @@ def prettify(col):
                .replace("_", " ")
                .title())
 
+# Columns whose CIs come from repetition noise (see README "Measurement").
+# Other CIs (e.g. rougeL_ci_*) resample documents; every config shares the
+# documents, so those overlap almost always and would make everything tie.
+TIE_CI_COLS = ("energy_J", "latency_s")
+
+def ci_of(row, col, value):
+    """(low, high) from <col>_ci_low/<col>_ci_high, or (value, value) if absent."""
+    lo = to_float(row.get(col + "_ci_low"))
+    hi = to_float(row.get(col + "_ci_high"))
+    if lo is None or hi is None:
+        return (value, value)
+    return (lo, hi)
+
+def ci_dominates(b, a):
+    """True if b beats a: never clearly worse, clearly better on one axis.
+    Overlapping intervals count as a tie (X minimized, Y maximized)."""
+    (bxl, bxh), (byl, byh) = b[5], b[6]
+    (axl, axh), (ayl, ayh) = a[5], a[6]
+    x_not_worse = bxl <= axh
+    y_not_worse = byh >= ayl
+    x_better = bxh < axl
+    y_better = byl > ayh
+    return x_not_worse and y_not_worse and (x_better or y_better)
+
 def load_rows(path):
     with open(path, newline="", encoding="utf-8") as f:
         return list(csv.DictReader(f))
@@ -38,6 +62,11 @@ def main():
                         help="Column to use for point labels")
     parser.add_argument("--title",  default="Accuracy vs Energy (Pareto)",
                         help="Plot title")
+    parser.add_argument("--tie_ci", action="store_true",
+                        help="Treat configs as tied when their confidence "
+                             "intervals (<col>_ci_low/_ci_high) overlap; only "
+                             "for " + ", ".join(TIE_CI_COLS) + ", other axes "
+                             "compare point values")
     args = parser.parse_args()
 
     rows = load_rows(args.csv)
@@ -47,31 +76,48 @@ def main():
         x = to_float(r.get(args.x)); y = to_float(r.get(args.y))
         lab = r.get(args.label, "")
         if x is None or y is None: continue
-        pts.append((x, y, lab))
+        xci, yci = ci_of(r, args.x, x), ci_of(r, args.y, y)
+        # Intervals used for ties: point values outside TIE_CI_COLS
+        xtie = xci if args.x in TIE_CI_COLS else (x, x)
+        ytie = yci if args.y in TIE_CI_COLS else (y, y)
+        pts.append((x, y, lab, xci, yci, xtie, ytie))
     if not pts:
         print("No valid data points.")
         return
 
-    # Compute Pareto: best Y for each unique X
-    best_for_x = {}
-    for x, y, lab in pts:
-        if x not in best_for_x or y > best_for_x[x][0]:
-            best_for_x[x] = (y, lab)
-    # Sort by X
-    candidate = sorted(((x, ylab[0], ylab[1]) for x, ylab in best_for_x.items()), key=lambda t: t[0])
-    # Envelope: monotonic non-decreasing Y
-    envelope = []
-    max_y = -math.inf
-    for x, y, lab in candidate:
-        if y >= max_y:
-            envelope.append((x, y, lab))
-            max_y = y
+    if args.tie_ci:
+        # Frontier: every point no other point beats outside its CI
+        envelope = sorted(((p[0], p[1], p[2]) for p in pts
+                           if not any(ci_dominates(q, p) for q in pts if q is not p)),
+                          key=lambda t: t[0])
+    else:
+        # Compute Pareto: best Y for each unique X
+        best_for_x = {}
+        for x, y, lab, *_ in pts:
+            if x not in best_for_x or y > best_for_x[x][0]:
+                best_for_x[x] = (y, lab)
+        # Sort by X
+        candidate = sorted(((x, ylab[0], ylab[1]) for x, ylab in best_for_x.items()), key=lambda t: t[0])
+        # Envelope: monotonic non-decreasing Y
+        envelope = []
+        max_y = -math.inf
+        for x, y, lab in candidate:
+            if y >= max_y:
+                envelope.append((x, y, lab))
+                max_y = y
 
-    # Plot all
-    xs_all, ys_all, labs_all = zip(*pts)
+    # Plot all, with CI error bars when available
+    xs_all, ys_all, labs_all, xci, yci, _, _ = zip(*pts)
     plt.figure(figsize=(10, 7))
+    # matplotlib rejects negative error lengths
+    xerr = [[max(0.0, x - lo) for x, (lo, _) in zip(xs_all, xci)],
+            [max(0.0, hi - x) for x, (_, hi) in zip(xs_all, xci)]]
+    yerr = [[max(0.0, y - lo) for y, (lo, _) in zip(ys_all, yci)],
+            [max(0.0, hi - y) for y, (_, hi) in zip(ys_all, yci)]]
+    plt.errorbar(xs_all, ys_all, xerr=xerr, yerr=yerr, fmt='none',
+                 ecolor='gray', alpha=0.4, capsize=2)
     plt.scatter(xs_all, ys_all, s=60, alpha=0.6, label="All Trials")
-    for x, y, lab in pts:
+    for x, y, lab, *_ in pts:
         plt.annotate(lab, (x, y), fontsize=8, xytext=(3,3), textcoords='offset points')
 
     # Plot frontier
@@ -1,10 +1,21 @@
 
 // ===== src/config.cpp =====
 #include "../header/config.hpp"
+#include "../header/utils.hpp"
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <fstream>
 #include <stdexcept>
 
+// Reject keys outside DecodingSpec::keys() and max_new_tokens (the length
+// cap, applied by StoppingCriteria) so typos don't pass silently
+static void checkDecodingKey(const std::string &section, const std::string &key) {
+    const auto &keys = DecodingSpec::keys();
+    if (key != "max_new_tokens" && std::find(keys.begin(), keys.end(), key) == keys.end()) {
+        throw std::runtime_error("Unknown key in " + section + ": '" + key + "'");
+    }
+}
+
 Config Config::load(const std::string &filename) {
     std::ifstream in(filename);
     if (!in.is_open()) {
@@ -21,6 +32,101 @@ Config Config::load(const std::string &filename) {
     cfg.results_dir    = j.at("results_dir").get<std::string>();
     cfg.num_trials     = j.at("num_trials").get<int>();
 
+    // Optional generation settings
+    cfg.max_new_tokens = j.value("max_new_tokens", 50);
+    cfg.eos_ids        = j.value("eos_ids", std::vector<int64_t>{});
+    cfg.stop_strings   = j.value("stop_strings", std::vector<std::string>{});
+    cfg.perf_counters  = j.value("perf_counters", false);
+    cfg.context_length = j.value("context_length", 0);
+    cfg.context_policy = j.value("context_policy", std::string("keep_head"));
+    cfg.prefill_chunk  = j.value("prefill_chunk", 512);
+
+    // Optional measurement protocol
+    if (j.contains("measurement")) {
+        const auto &m = j.at("measurement");
+        auto &mc = cfg.measurement;
+        mc.warmup_examples   = m.value("warmup_examples", mc.warmup_examples);
+        mc.repetitions       = m.value("repetitions", mc.repetitions);
+        mc.repeat_mode       = m.value("repeat_mode", mc.repeat_mode);
+        mc.mad_threshold     = m.value("mad_threshold", mc.mad_threshold);
+        mc.bootstrap_samples = m.value("bootstrap_samples", mc.bootstrap_samples);
+        mc.confidence        = m.value("confidence", mc.confidence);
+        mc.seed              = m.value("seed", mc.seed);
+        if (mc.repetitions < 1) {
+            throw std::runtime_error("measurement.repetitions must be >= 1");
+        }
+        if (mc.repeat_mode != "example" && mc.repeat_mode != "trial") {
+            throw std::runtime_error("measurement.repeat_mode must be 'example' or 'trial'");
+        }
+        if (mc.warmup_examples < 0) {
+            throw std::runtime_error("measurement.warmup_examples must be >= 0");
+        }
+        if (!(mc.mad_threshold >= 0.0)) {
+            throw std::runtime_error("measurement.mad_threshold must be >= 0 (0 = off)");
+        }
+        if (mc.bootstrap_samples < 0) {
+            throw std::runtime_error("measurement.bootstrap_samples must be >= 0");
+        }
+        if (!(mc.confidence > 0.0 && mc.confidence < 1.0)) {
+            throw std::runtime_error("measurement.confidence must be in (0, 1), e.g. 0.95");
+        }
+    }
+
+    // Optional decoding defaults and search space
+    if (j.contains("decoding")) {
+        const auto &d = j.at("decoding");
+        auto &dc = cfg.decoding;
+        for (auto &it : d.items()) checkDecodingKey("decoding", it.key());
+        dc.strategy           = d.value("strategy", dc.strategy);
+        dc.temperature        = d.value("temperature", dc.temperature);
+        dc.top_k              = d.value("top_k", dc.top_k);
+        dc.top_p              = d.value("top_p", dc.top_p);
+        dc.repetition_penalty = d.value("repetition_penalty", dc.repetition_penalty);
+        dc.min_new_tokens     = d.value("min_new_tokens", dc.min_new_tokens);
+        dc.seed               = d.value("seed", dc.seed);
+        cfg.max_new_tokens    = d.value("max_new_tokens", cfg.max_new_tokens);
+    }
+    if (cfg.max_new_tokens <= 0) {
+        throw std::runtime_error("max_new_tokens must be positive");
+    }
+    try {
+        cfg.decoding.validate();
+    } catch (const std::invalid_argument &e) {
+        throw std::runtime_error(std::string("decoding: ") + e.what());
+    }
+
+    // Decoding search axes: each value must yield a valid spec on top of
+    // the defaults, so a bad value fails here rather than mid-search
+    if (j.contains("decoding_space")) {
+        for (auto &it : j.at("decoding_space").items()) {
+            const std::string &key = it.key();
+            checkDecodingKey("decoding_space", key);
+            auto &values = cfg.decoding_space[key];
+            for (const auto &v : it.value()) {
+                if (v.is_string()) {
+                    values.push_back(v.get<std::string>());
+                } else if (v.is_number()) {
+                    values.push_back(v.dump());
+                } else {
+                    throw std::runtime_error("decoding_space." + key
+                                             + ": values must be strings or numbers");
+                }
+                try {
+                    if (key == "max_new_tokens") {
+                        if (utils::parseInt(key, values.back()) <= 0) {
+                            throw std::invalid_argument("max_new_tokens must be positive");
+                        }
+                    } else {
+                        DecodingSpec::fromPromptConfig({{key, values.back()}}, cfg.decoding)
+                            .validate();
+                    }
+                } catch (const std::invalid_argument &e) {
+                    throw std::runtime_error("decoding_space." + key + ": " + e.what());
+                }
+            }
+        }
+    }
+
     // Load prompt_space entries correctly
     for (auto &it : j.at("prompt_space").items()) {
         const std::string &key = it.key();
@@ -0,0 +1,75 @@
+// ===== src/context.cpp =====
+#include "../header/context.hpp"
+#include "../header/prompts.hpp"
+#include "../header/trace.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+ContextPolicy parseContextPolicy(const std::string &name) {
+    if (name == "keep_head")      return ContextPolicy::KeepHead;
+    if (name == "keep_tail")      return ContextPolicy::KeepTail;
+    if (name == "sliding_window") return ContextPolicy::SlidingWindow;
+    throw std::invalid_argument("Unknown context_policy: " + name);
+}
+
+ContextManager::ContextManager(const Tokenizer &tokenizer,
+                               int context_length,
+                               ContextPolicy policy)
+    : tokenizer_(tokenizer)
+    , context_length_(context_length)
+    , policy_(policy)
+{}
+
+void ContextManager::render(const std::string &doc,
+                            const std::map<std::string, std::string> &cfg,
+                            FittedPrompt &out) const {
+    {
+        EAPO_TRACE_SCOPE("render_prompt");
+        PromptGenerator::renderPrompt(doc, cfg, out.prompt);
+    }
+    {
+        EAPO_TRACE_SCOPE("encode");
+        tokenizer_.encode(out.prompt, out.ids);
+    }
+}
+
+void ContextManager::fit(const std::string &doc,
+                         const std::map<std::string, std::string> &cfg,
+                         int max_new_tokens,
+                         FittedPrompt &out) const {
+    out.truncated_tokens = 0;
+    render(doc, cfg, out);
+    if (context_length_ <= 0 || policy_ == ContextPolicy::SlidingWindow) {
+        return;
+    }
+
+    const int budget = context_length_ - max_new_tokens;
+    if (budget <= 0) {
+        throw std::runtime_error("context_length must exceed max_new_tokens");
+    }
+    if (static_cast<int>(out.ids.size()) <= budget) return;
+
+    // Cut the document at token granularity, decode it back to text and
+    // re-render; tokenization at the seams can shift by a few tokens, so
+    // shrink by the remaining overflow until it fits.
+    EAPO_TRACE_SCOPE("truncate_context");
+    const std::vector<int> doc_ids = tokenizer_.encode(doc);
+    const int doc_len = static_cast<int>(doc_ids.size());
+    int keep = doc_len - (static_cast<int>(out.ids.size()) - budget);
+
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        keep = std::max(keep, 0);
+        std::vector<int> kept = (policy_ == ContextPolicy::KeepHead)
+            ? std::vector<int>(doc_ids.begin(), doc_ids.begin() + keep)
+            : std::vector<int>(doc_ids.end() - keep, doc_ids.end());
+        render(tokenizer_.decode(kept), cfg, out);
+        out.truncated_tokens = doc_len - keep;
+
+        int overflow = static_cast<int>(out.ids.size()) - budget;
+        if (overflow <= 0) return;
+        if (keep == 0) break;
+        keep -= overflow;
+    }
+    throw std::runtime_error("Prompt instruction alone exceeds the context window ("
+                             + std::to_string(context_length_) + " tokens)");
+}
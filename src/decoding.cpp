@@ -0,0 +1,268 @@
+// ===== src/decoding.cpp =====
+#include "../header/decoding.hpp"
+#include "../header/trace.hpp"
+#include "../header/utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+#if defined(__GNUC__)
+// Four floats per op: SSE2 / NEON baseline, so no -march flag is needed
+typedef float F32x4 __attribute__((vector_size(16)));
+typedef int32_t I32x4 __attribute__((vector_size(16)));
+
+inline F32x4 load4(const float *p) { F32x4 v; std::memcpy(&v, p, sizeof v); return v; }
+inline void store4(float *p, F32x4 v) { std::memcpy(p, &v, sizeof v); }
+inline F32x4 select4(I32x4 mask, F32x4 a, F32x4 b) {
+    return (F32x4)(((I32x4)a & mask) | ((I32x4)b & ~mask));
+}
+
+// exp(x) for x <= 0 (softmax after max subtraction), rel. error < 1e-6;
+// std::exp is a libm call and keeps the loop scalar
+inline F32x4 exp4(F32x4 x) {
+    const F32x4 lo = F32x4{} - 87.0f;
+    I32x4 under = x < lo;
+    x = select4(under, lo, x);
+    F32x4 n = (x * 1.44269504f + 12582912.0f) - 12582912.0f;  // round(x / ln2)
+    F32x4 r = x - n * 0.693145751953125f - n * 1.428606765330187e-06f;
+    F32x4 p = r * (1.0f / 720.0f) + (1.0f / 120.0f);
+    p = p * r + (1.0f / 24.0f);
+    p = p * r + (1.0f / 6.0f);
+    p = p * r + 0.5f;
+    p = p * r + 1.0f;
+    p = p * r + 1.0f;
+    I32x4 bits = (__builtin_convertvector(n, I32x4) + 127) << 23;  // 2^n
+    return select4(under, F32x4{}, p * (F32x4)bits);
+}
+#endif
+
+float maxOf(const float *x, int64_t n) {
+    float mx = -std::numeric_limits<float>::infinity();
+    int64_t i = 0;
+#if defined(__GNUC__)
+    F32x4 m = F32x4{} + mx;
+    for (; i + 4 <= n; i += 4) {
+        F32x4 v = load4(x + i);
+        m = select4(v > m, v, m);
+    }
+    for (int j = 0; j < 4; ++j) mx = std::max(mx, m[j]);
+#endif
+    for (; i < n; ++i) mx = std::max(mx, x[i]);
+    return mx;
+}
+
+// x[i] = exp((x[i] - mx) * scale) in place; returns the sum
+double expSum(float *x, int64_t n, float mx, float scale) {
+    double total = 0.0;
+    int64_t i = 0;
+#if defined(__GNUC__)
+    F32x4 acc{};
+    for (; i + 4 <= n; i += 4) {
+        F32x4 e = exp4((load4(x + i) - mx) * scale);
+        store4(x + i, e);
+        acc += e;
+    }
+    for (int j = 0; j < 4; ++j) total += acc[j];
+#endif
+    for (; i < n; ++i) {
+        x[i] = std::exp((x[i] - mx) * scale);
+        total += x[i];
+    }
+    return total;
+}
+
+} // namespace
+
+DecodingSpec DecodingSpec::fromPromptConfig(const std::map<std::string, std::string> &cfg,
+                                            const DecodingSpec &base) {
+    DecodingSpec spec = base;
+    auto get = [&](const std::string &key, auto setter) {
+        auto it = cfg.find(key);
+        if (it != cfg.end() && !it->second.empty()) setter(key, it->second);
+    };
+    using S = const std::string &;
+    get("strategy",           [&](S, S v) { spec.strategy = v; });
+    get("temperature",        [&](S k, S v) { spec.temperature = utils::parseFloat(k, v); });
+    get("top_k",              [&](S k, S v) { spec.top_k = utils::parseInt(k, v); });
+    get("top_p",              [&](S k, S v) { spec.top_p = utils::parseFloat(k, v); });
+    get("repetition_penalty", [&](S k, S v) { spec.repetition_penalty = utils::parseFloat(k, v); });
+    get("min_new_tokens",     [&](S k, S v) { spec.min_new_tokens = utils::parseInt(k, v); });
+    get("seed",               [&](S k, S v) { spec.seed = utils::parseUint64(k, v); });
+    return spec;
+}
+
+const std::vector<std::string> &DecodingSpec::keys() {
+    static const std::vector<std::string> names = {
+        "strategy", "temperature", "top_k", "top_p",
+        "repetition_penalty", "min_new_tokens", "seed"
+    };
+    return names;
+}
+
+void DecodingSpec::validate() const {
+    if (strategy != "greedy" && strategy != "sample") {
+        throw std::invalid_argument("Unknown decoding strategy: " + strategy);
+    }
+    if (!(temperature >= 0.0f)) {
+        throw std::invalid_argument("temperature must be >= 0");
+    }
+    if (top_k < 0) {
+        throw std::invalid_argument("top_k must be >= 0");
+    }
+    if (!(top_p > 0.0f && top_p <= 1.0f)) {
+        throw std::invalid_argument("top_p must be in (0, 1]");
+    }
+    if (!(repetition_penalty > 0.0f)) {
+        throw std::invalid_argument("repetition_penalty must be positive");
+    }
+    if (min_new_tokens < 0) {
+        throw std::invalid_argument("min_new_tokens must be >= 0");
+    }
+}
+
+Sampler::Sampler(DecodingSpec spec, std::vector<int64_t> eos_ids)
+    : spec_(std::move(spec))
+    , eos_ids_(std::move(eos_ids))
+{
+    spec_.validate();
+    greedy_ = spec_.strategy == "greedy" || spec_.temperature <= 0.0f;
+    reset(0);
+}
+
+void Sampler::reset(uint64_t sequence_id) {
+    // splitmix64 of (seed, sequence) gives independent per-sequence streams
+    uint64_t z = spec_.seed + 0x9E3779B97F4A7C15ULL * (sequence_id + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    rng_.seed(z ^ (z >> 31));
+
+    for (int64_t id : seen_ids_) seen_[id] = 0;
+    seen_ids_.clear();
+}
+
+void Sampler::observe(int64_t id) {
+    if (spec_.repetition_penalty == 1.0f || id < 0) return;
+    if (static_cast<size_t>(id) >= seen_.size()) seen_.resize(id + 1, 0);
+    if (!seen_[id]) {
+        seen_[id] = 1;
+        seen_ids_.push_back(id);
+    }
+}
+
+void Sampler::observe(const std::vector<int> &ids) {
+    for (int id : ids) observe(static_cast<int64_t>(id));
+}
+
+int64_t Sampler::argmax(const float *logits, int64_t vocab) const {
+    int64_t best = 0;
+    float best_val = logits[0];
+    for (int64_t i = 1; i < vocab; ++i) {
+        if (logits[i] > best_val) { best_val = logits[i]; best = i; }
+    }
+    return best;
+}
+
+int64_t Sampler::next(float *logits, int64_t vocab, int num_generated) {
+    EAPO_TRACE_SCOPE("sample");
+    constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+    // Min length: EOS can't win before min_new_tokens
+    if (num_generated < spec_.min_new_tokens) {
+        for (int64_t eos : eos_ids_) {
+            if (eos >= 0 && eos < vocab) logits[eos] = kNegInf;
+        }
+    }
+
+    // Repetition penalty, touching only tokens already seen
+    if (spec_.repetition_penalty != 1.0f) {
+        const float p = spec_.repetition_penalty;
+        for (int64_t id : seen_ids_) {
+            if (id >= vocab) continue;
+            float &x = logits[id];
+            x = (x > 0.0f) ? x / p : x * p;
+        }
+    }
+
+    int64_t id = greedy_ ? argmax(logits, vocab) : sample(logits, vocab);
+    observe(id);
+    return id;
+}
+
+int64_t Sampler::sample(float *logits, int64_t vocab) {
+    const float scale = 1.0f / spec_.temperature;
+    auto desc = [logits](int32_t a, int32_t b) { return logits[a] > logits[b]; };
+
+    // Candidate set: the top-k via partial selection, else the whole vocab
+    int64_t k = (spec_.top_k > 0) ? std::min<int64_t>(spec_.top_k, vocab) : vocab;
+    if (k < vocab || spec_.top_p < 1.0f) {
+        idx_.resize(vocab);
+        std::iota(idx_.begin(), idx_.end(), 0);
+    }
+    if (k < vocab) {
+        std::nth_element(idx_.begin(), idx_.begin() + k, idx_.end(), desc);
+    }
+
+    // Max + exp-sum over the candidates (temperature folded in). The top-k
+    // gather stays scalar; the full-vocab passes run four lanes wide.
+    float mx = -std::numeric_limits<float>::infinity();
+    double total = 0.0;
+    if (k < vocab) {
+        for (int64_t i = 0; i < k; ++i) mx = std::max(mx, logits[idx_[i]]);
+        for (int64_t i = 0; i < k; ++i) {
+            float &x = logits[idx_[i]];
+            x = std::exp((x - mx) * scale);
+            total += x;
+        }
+    } else {
+        mx = maxOf(logits, vocab);
+        total = expSum(logits, vocab, mx, scale);
+    }
+    // logits now hold unnormalized probabilities for the candidates
+
+    // Nucleus: smallest prefix (by probability) with mass >= top_p. Sort
+    // only a growing head of the candidates rather than all of them.
+    int64_t n = k;
+    double mass = total;
+    if (spec_.top_p < 1.0f) {
+        const double target = spec_.top_p * total;
+        int64_t head = std::min<int64_t>(k, 64);
+        for (;;) {
+            std::partial_sort(idx_.begin(), idx_.begin() + head, idx_.begin() + k, desc);
+            double cum = 0.0;
+            int64_t i = 0;
+            while (i < head && cum < target) cum += logits[idx_[i++]];
+            if (cum >= target || head == k) {
+                n = i;
+                mass = cum;
+                break;
+            }
+            head = std::min<int64_t>(k, head * 4);
+        }
+    }
+
+    // Draw
+    std::uniform_real_distribution<double> uni(0.0, mass);
+    double u = uni(rng_);
+    if (n == vocab) {
+        for (int64_t i = 0; i < vocab; ++i) {
+            u -= logits[i];
+            if (u <= 0.0) return i;
+        }
+        // Rounding left u > 0: take the last token that has any mass
+        for (int64_t i = vocab - 1; i > 0; --i) {
+            if (logits[i] > 0.0f) return i;
+        }
+        return 0;
+    }
+    for (int64_t i = 0; i < n; ++i) {
+        u -= logits[idx_[i]];
+        if (u <= 0.0) return idx_[i];
+    }
+    return idx_[n - 1];
+}
@@ -1,8 +1,17 @@
 // ===== src/evaluator.cpp =====
 
 #include "../header/evaluator.hpp"
+#include "../header/trace.hpp"
+#include "../header/utils.hpp"
+#include "../header/alloc_counter.hpp"
 #include <fstream>
 #include <chrono>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <ATen/Parallel.h>
 
 #ifdef USE_NVML
 #include <nvml.h>
@@ -14,45 +23,228 @@ Evaluator::Evaluator(const Tokenizer &tokenizer,
   : tokenizer_(tokenizer)
   , model_(model)
   , config_(config)
+  , context_(tokenizer, config.context_length,
+             parseContextPolicy(config.context_policy))
 {
 #ifdef USE_NVML
     nvmlInit();
 #endif
+    // Default stopping criteria from config; prompt configs refine it
+    baseStop_.max_new_tokens = config_.max_new_tokens;
+    baseStop_.eos_ids        = config_.eos_ids;
+    baseStop_.stop_strings   = config_.stop_strings;
+    if (baseStop_.eos_ids.empty() && tokenizer_.eosId() >= 0) {
+        baseStop_.eos_ids.push_back(tokenizer_.eosId());
+    }
+
+    // The model enforces the window itself (sliding window); the head/tail
+    // policies truncate the document up front so it never triggers
+    model_.setContextWindow(config_.context_length);
+    model_.setPrefillChunk(config_.prefill_chunk);
+
+    if (config_.perf_counters) {
+        perf_ = std::make_unique<PerfCounterGroup>();
+        if (!perf_->available()) {
+            std::cerr << "Warning: hardware counters unavailable ("
+                      << perf_->reason() << "); counter metrics will be NaN\n";
+        }
+    }
 }
 
-void Evaluator::run(const std::string &prompt_cfg_json,
-                    const std::string &dataset_path,
-                    const std::string &results_dir)
+std::map<std::string, std::string>
+Evaluator::parsePromptConfig(const std::string &prompt_cfg_json)
 {
-    // 1) Parse JSON prompt configuration
+    EAPO_TRACE_SCOPE("parse_prompt_config");
+    // Convert to std::map<string,string> for PromptGenerator
     auto jcfg = nlohmann::json::parse(prompt_cfg_json);
-
-    // 2) Convert to std::map<string,string> for PromptGenerator
     std::map<std::string, std::string> cfg_map;
     for (auto &item : jcfg.items()) {
         if (item.value().is_string()) {
             cfg_map[item.key()] = item.value().get<std::string>();
+        } else if (item.value().is_number()) {
+            // Numeric knobs (max_new_tokens, temperature, top_p, ...)
+            cfg_map[item.key()] = item.value().dump();
         }
     }
+    return cfg_map;
+}
+
+Evaluator::Decoder
+Evaluator::makeDecoder(const std::map<std::string, std::string> &cfg_map) const
+{
+    return Decoder{
+        StoppingCriteria(tokenizer_, StoppingCriteria::fromPromptConfig(cfg_map, baseStop_)),
+        Sampler(DecodingSpec::fromPromptConfig(cfg_map, config_.decoding), baseStop_.eos_ids)
+    };
+}
+
+void Evaluator::runExample(const Record &rec,
+                           const std::map<std::string, std::string> &cfg_map,
+                           Decoder &dec,
+                           ExampleResult &ex)
+{
+#ifdef USE_NVML
+    nvmlDevice_t device;
+    nvmlDeviceGetHandleByIndex(0, &device);
+#endif
+    // Without the reset the kernel's peak is the process lifetime peak,
+    // which must not be reported as this example's
+    const bool rssReset = utils::resetPeakRss();
+    if (!rssReset && !rssWarned_) {
+        std::cerr << "Warning: cannot reset peak RSS (/proc/self/clear_refs not "
+                     "writable); peak_rss_MB will be NaN\n";
+        rssWarned_ = true;
+    }
+    // Pick up new threads (e.g. the intra-op pool) before anything is
+    // measured: this scans /proc and allocates
+    if (perf_) perf_->sync();
+    const uint64_t a0 = alloc::count();
+
+    // Render & tokenize into the scratch prompt, truncating the document
+    // to fit the context window
+    context_.fit(rec.doc, cfg_map, dec.criteria.maxNewTokens(), ex.fitted);
+    dec.sampler.reset(rec.id);
+
+    // Sample power & timestamp before
+#ifdef USE_NVML
+    unsigned int p0_mw;
+    nvmlDeviceGetPowerUsage(device, &p0_mw);
+    double p0 = p0_mw / 1000.0;
+#endif
+    // Counters are enabled outside the timed region so their ioctls
+    // don't count toward latency
+    if (perf_) perf_->start();
+    auto t0 = std::chrono::steady_clock::now();
+    const uint64_t a1 = alloc::count();
+
+    // Generate (detokenized incrementally, stops early per criteria)
+    {
+        EAPO_TRACE_SCOPE("generate");
+        model_.generate(ex.fitted.ids, dec.criteria, dec.sampler, ex.gen);
+    }
+
+    // Sample allocations, timestamp, counters & power after
+    const uint64_t a2 = alloc::count();
+    auto t1 = std::chrono::steady_clock::now();
+    ex.perf = perf_ ? perf_->stop() : PerfCounts::unavailable();
+    ex.allocs         = a2 - a0;
+    ex.generateAllocs = a2 - a1;
+#ifdef USE_NVML
+    unsigned int p1_mw;
+    nvmlDeviceGetPowerUsage(device, &p1_mw);
+    double p1 = p1_mw / 1000.0;
+#endif
+
+    ex.truncatedTokens = ex.fitted.truncated_tokens + ex.gen.truncated_tokens;
+    ex.peakRssMB       = rssReset ? utils::peakRssBytes() / (1024.0 * 1024.0)
+                                  : std::numeric_limits<double>::quiet_NaN();
 
-    // Open input JSONL dataset
+    ex.latencyS = std::chrono::duration<double>(t1 - t0).count();
+    ex.energyJ  =
+#ifdef USE_NVML
+        ((p0 + p1) / 2.0) * ex.latencyS;
+#else
+        0.0;
+#endif
+}
+
+std::vector<Evaluator::Record>
+Evaluator::loadDataset(const std::string &dataset_path)
+{
     std::ifstream fin(dataset_path);
     if (!fin) {
         throw std::runtime_error("Failed to open dataset file: " + dataset_path);
     }
+    std::vector<Record> records;
+    std::string line;
+    while (std::getline(fin, line)) {
+        EAPO_TRACE_SCOPE("parse_json");
+        auto rec = nlohmann::json::parse(line);
+        records.push_back({records.size(),
+                           rec["doc"].get<std::string>(),
+                           rec["ref"].get<std::string>()});
+    }
+    return records;
+}
+
+size_t Evaluator::warmup(const std::vector<Record> &records,
+                         const std::map<std::string, std::string> &cfg_map,
+                         Decoder &dec)
+{
+    size_t n = static_cast<size_t>(config_.measurement.warmup_examples);
+    if (n >= records.size()) {
+        // Nothing left to measure; metrics would silently be all zero
+        throw std::runtime_error("measurement.warmup_examples (" + std::to_string(n)
+                                 + ") must be less than the dataset size ("
+                                 + std::to_string(records.size()) + ")");
+    }
+    for (size_t i = 0; i < n; ++i) {
+        EAPO_TRACE_SCOPE("warmup");
+        runExample(records[i], cfg_map, dec, repScratch_);
+    }
+    return n;
+}
+
+void Evaluator::measureExample(const Record &rec,
+                               const std::map<std::string, std::string> &cfg_map,
+                               Decoder &dec,
+                               int repetitions,
+                               ExampleResult &ex)
+{
+    EAPO_TRACE_SCOPE("example");
+    runExample(rec, cfg_map, dec, ex);
+    {
+        EAPO_TRACE_SCOPE("rouge");
+        ex.rougeL = computeRougeL(ex.gen.text, rec.ref);
+    }
+    ex.latencyMadS = 0.0;
+    ex.repsKept    = 1;
+    ex.rejected    = 0;
+    ex.keptLatencyS.assign(1, ex.latencyS);
+    ex.keptEnergyJ.assign(1, ex.energyJ);
+    if (repetitions <= 1) return;
+
+    repLatency_.assign(1, ex.latencyS);
+    repEnergy_.assign(1, ex.energyJ);
+    for (int r = 1; r < repetitions; ++r) {
+        runExample(rec, cfg_map, dec, repScratch_);
+        repLatency_.push_back(repScratch_.latencyS);
+        repEnergy_.push_back(repScratch_.energyJ);
+    }
+
+    // Outliers are judged on latency (energy is derived from the same
+    // interval) and a rejected repetition is dropped from both
+    auto kept = stats::inliersMad(repLatency_, config_.measurement.mad_threshold);
+    ex.keptLatencyS = stats::select(repLatency_, kept);
+    ex.keptEnergyJ  = stats::select(repEnergy_, kept);
+    ex.latencyS    = stats::median(ex.keptLatencyS);
+    ex.energyJ     = stats::median(ex.keptEnergyJ);
+    ex.latencyMadS = stats::mad(ex.keptLatencyS);
+    ex.repsKept    = static_cast<int>(kept.size());
+    ex.rejected    = repLatency_.size() - kept.size();
+}
+
+void Evaluator::run(const std::string &prompt_cfg_json,
+                    const std::string &dataset_path,
+                    const std::string &results_dir)
+{
+    // 1) Parse JSON prompt configuration
+    auto cfg_map = parsePromptConfig(prompt_cfg_json);
+
+    // 2) Stopping criteria (e.g. from brevity) and decoding strategy
+    Decoder dec = makeDecoder(cfg_map);
+
+    // Load input JSONL dataset
+    auto records = loadDataset(dataset_path);
 
     // Prepare output CSV
     std::ofstream fout(results_dir + "/eval_per_example.csv");
     if (!fout) {
         throw std::runtime_error("Failed to open output CSV: " + results_dir + "/eval_per_example.csv");
     }
-    fout << "doc,prompt,generated,rougeL,energy_J,latency_s,tokens,tpj\n";
-
-#ifdef USE_NVML
-    // Initialize NVML device handle
-    nvmlDevice_t device;
-    nvmlDeviceGetHandleByIndex(0, &device);
-#endif
+    fout << "doc,prompt,generated,rougeL,energy_J,latency_s,tokens,tpj,new_tokens,stop_reason,"
+            "cycles,instructions,llc_misses,branch_misses,truncated_tokens,peak_rss_MB,"
+            "latency_mad_s,reps_kept,allocs,allocs_per_token,forward_allocs,loop_allocs_per_token\n";
 
     // Helper to escape quotes in CSV fields
     auto escape_csv = [&](const std::string &s) {
@@ -65,70 +257,56 @@ void Evaluator::run(const std::string &prompt_cfg_json,
         return out;
     };
 
-    std::string line;
-    while (std::getline(fin, line)) {
-        auto rec = nlohmann::json::parse(line);
-        std::string doc = rec["doc"].get<std::string>();
-
-        // Render prompt
-        std::string prompt = PromptGenerator::renderPrompt(doc, cfg_map);
+    // Warmup examples are generated but not reported
+    size_t first = warmup(records, cfg_map, dec);
 
-        // Tokenize: int → int64_t
-        auto tmp_in = tokenizer_.encode(prompt);
-        std::vector<int64_t> input_ids(tmp_in.begin(), tmp_in.end());
-
-        // Sample power & timestamp before
-#ifdef USE_NVML
-        unsigned int p0_mw;
-        nvmlDeviceGetPowerUsage(device, &p0_mw);
-        double p0 = p0_mw / 1000.0;
-#endif
-        auto t0 = std::chrono::steady_clock::now();
-
-        // Generate
-        auto output_ids = model_.generate(input_ids);
-
-        // Sample power & timestamp after
-        auto t1 = std::chrono::steady_clock::now();
-#ifdef USE_NVML
-        unsigned int p1_mw;
-        nvmlDeviceGetPowerUsage(device, &p1_mw);
-        double p1 = p1_mw / 1000.0;
-#endif
+    ExampleResult ex;  // reused across examples
+    for (size_t i = first; i < records.size(); ++i) {
+        const Record &rec = records[i];
+        measureExample(rec, cfg_map, dec, config_.measurement.repetitions, ex);
 
         // Compute metrics
-        double latency = std::chrono::duration<double>(t1 - t0).count();
-        double energy  =
-#ifdef USE_NVML
-            ((p0 + p1) / 2.0) * latency;
-#else
-            0.0;
-#endif
-        int tokens = static_cast<int>(output_ids.size());
-        double tpj = (energy > 0.0 ? tokens / energy : 0.0);
-
-        // Decode
-        std::vector<int> tmp_out(output_ids.begin(), output_ids.end());
-        std::string gen_text = tokenizer_.decode(tmp_out);
-
-        // Rouge-L
-        double rougeL = computeRougeL(gen_text, rec["ref"].get<std::string>());
+        int tokens = ex.gen.prompt_tokens + ex.gen.num_generated;
+        double tpj = (ex.energyJ > 0.0 ? tokens / ex.energyJ : 0.0);
+        double allocsPerToken = ex.gen.num_generated > 0
+            ? static_cast<double>(ex.generateAllocs) / ex.gen.num_generated : 0.0;
+        double loopAllocsPerToken = ex.gen.loop_steps > 0
+            ? static_cast<double>(ex.gen.loop_allocs) / ex.gen.loop_steps : 0.0;
 
         // Write CSV row
         fout
-          << '"' << escape_csv(doc)      << "\","
-          << '"' << escape_csv(prompt)   << "\","
-          << '"' << escape_csv(gen_text) << "\","
-          << rougeL   << ","
-          << energy   << ","
-          << latency  << ","
-          << tokens   << ","
-          << tpj      << "\n";
+          << '"' << escape_csv(rec.doc)     << "\","
+          << '"' << escape_csv(ex.fitted.prompt) << "\","
+          << '"' << escape_csv(ex.gen.text) << "\","
+          << ex.rougeL   << ","
+          << ex.energyJ  << ","
+          << ex.latencyS << ","
+          << tokens      << ","
+          << tpj         << ","
+          << ex.gen.num_generated << ","
+          << stopReasonName(ex.gen.stop_reason) << ","
+          << ex.perf.cycles       << ","
+          << ex.perf.instructions << ","
+          << ex.perf.llcMisses    << ","
+          << ex.perf.branchMisses << ","
+          << ex.truncatedTokens   << ","
+          << ex.peakRssMB         << ","
+          << ex.latencyMadS       << ","
+          << ex.repsKept          << ","
+          << ex.allocs            << ","
+          << allocsPerToken       << ","
+          << ex.gen.forward_allocs << ","
+          << loopAllocsPerToken   << "\n";
     }
 
-    fin.close();
     fout.close();
 
+    writeRunMetadata(results_dir + "/run_metadata.json");
+
+    // Per-stage timings for this run (no-op unless built with EAPO_TRACE)
+    trace::exportChrome(results_dir + "/trace_eval.json");
+    trace::clear();
+
     // TODO: optionally write summary.json here
 
 #ifdef USE_NVML
@@ -142,86 +320,158 @@ Evaluator::SummaryMetrics
 Evaluator::evaluateSummary(const std::string &prompt_cfg_json)
 {
     // Parse prompt config JSON
-    auto jcfg = nlohmann::json::parse(prompt_cfg_json);
-    std::map<std::string, std::string> cfg_map;
-    for (auto &item : jcfg.items()) {
-        if (item.value().is_string()) {
-            cfg_map[item.key()] = item.value().get<std::string>();
-        }
-    }
+    auto cfg_map = parsePromptConfig(prompt_cfg_json);
+    Decoder dec = makeDecoder(cfg_map);
 
-    std::ifstream fin(config_.dataset_path);
-    if (!fin) {
-        throw std::runtime_error("Cannot open dataset: " + config_.dataset_path);
-    }
+    auto records = loadDataset(config_.dataset_path);
+    const auto &mc = config_.measurement;
 
 #ifdef USE_NVML
     nvmlInit();
-    nvmlDevice_t device;
-    nvmlDeviceGetHandleByIndex(0, &device);
-#endif
-
-    size_t count = 0;
-    double sumRouge = 0.0, sumEnergy = 0.0, sumLatency = 0.0;
-    size_t sumTokens = 0;
-    std::string line;
-
-    while (std::getline(fin, line)) {
-        auto rec = nlohmann::json::parse(line);
-        std::string doc = rec["doc"].get<std::string>();
-
-        // Build prompt & tokenize
-        std::string prompt = PromptGenerator::renderPrompt(doc, cfg_map);
-        auto tmp_in = tokenizer_.encode(prompt);
-        std::vector<int64_t> input_ids(tmp_in.begin(), tmp_in.end());
-
-        // Power & time before
-#ifdef USE_NVML
-        unsigned int p0_mw;
-        nvmlDeviceGetPowerUsage(device, &p0_mw);
-        double p0 = p0_mw / 1000.0;
-#endif
-        auto t0 = std::chrono::steady_clock::now();
-
-        // Generate
-        auto output_ids = model_.generate(input_ids);
-
-        auto t1 = std::chrono::steady_clock::now();
-#ifdef USE_NVML
-        unsigned int p1_mw;
-        nvmlDeviceGetPowerUsage(device, &p1_mw);
-        double p1 = p1_mw / 1000.0;
 #endif
 
-        double latency = std::chrono::duration<double>(t1 - t0).count();
-        double energy  =
-#ifdef USE_NVML
-            ((p0 + p1) / 2.0) * latency;
-#else
-            0.0;
-#endif
-        sumLatency += latency;
-        sumEnergy  += energy;
-        sumTokens  += output_ids.size();
+    size_t first = warmup(records, cfg_map, dec);
 
-        // Decode & Rouge
-        std::vector<int> tmp_out(output_ids.begin(), output_ids.end());
-        std::string gen_text = tokenizer_.decode(tmp_out);
-        double rouge   = computeRougeL(gen_text, rec["ref"].get<std::string>());
-        sumRouge += rouge;
+    // In "example" mode each example is repeated back to back; in "trial"
+    // mode the whole dataset is re-run per repetition and timing is
+    // aggregated over pass totals. Other metrics come from the first pass.
+    const bool perTrial = (mc.repeat_mode == "trial");
+    const int passes    = perTrial ? mc.repetitions : 1;
+    const int perEx     = perTrial ? 1 : mc.repetitions;
 
-        ++count;
+    size_t count = 0;
+    size_t sumTokens = 0, sumNewTokens = 0, sumTruncated = 0, rejected = 0;
+    uint64_t sumAllocs = 0, sumGenerateAllocs = 0;
+    uint64_t sumForwardAllocs = 0, sumLoopAllocs = 0, sumLoopSteps = 0;
+    double maxRssMB = 0.0;
+    PerfCounts sumPerf;
+    std::vector<double> rouges, passLatency, passEnergy;
+    std::vector<std::vector<double>> repLatencies, repEnergies;  // per example
+    ExampleResult ex;  // reused across examples
+
+    for (int pass = 0; pass < passes; ++pass) {
+        double lat = 0.0, energy = 0.0;
+        for (size_t i = first; i < records.size(); ++i) {
+            measureExample(records[i], cfg_map, dec, perEx, ex);
+            lat    += ex.latencyS;
+            energy += ex.energyJ;
+            if (pass > 0) continue;
+
+            ++count;
+            sumTokens         += ex.gen.prompt_tokens + ex.gen.num_generated;
+            sumNewTokens      += ex.gen.num_generated;
+            sumPerf           += ex.perf;
+            sumTruncated      += ex.truncatedTokens;
+            sumAllocs         += ex.allocs;
+            sumGenerateAllocs += ex.generateAllocs;
+            sumForwardAllocs  += ex.gen.forward_allocs;
+            sumLoopAllocs     += ex.gen.loop_allocs;
+            sumLoopSteps      += ex.gen.loop_steps;
+            maxRssMB           = std::isnan(ex.peakRssMB)
+                                 ? ex.peakRssMB  // NaN sticks through std::max
+                                 : std::max(maxRssMB, ex.peakRssMB);
+            rejected          += ex.rejected;
+            rouges.push_back(ex.rougeL);
+            repLatencies.push_back(ex.keptLatencyS);
+            repEnergies.push_back(ex.keptEnergyJ);
+        }
+        passLatency.push_back(lat);
+        passEnergy.push_back(energy);
     }
 
 #ifdef USE_NVML
     nvmlShutdown();
 #endif
 
+    const size_t B = static_cast<size_t>(std::max(mc.bootstrap_samples, 0));
     Evaluator::SummaryMetrics m;
-    m.rougeL         = (count ? sumRouge / count : 0.0);
-    m.energyTotalJ   = sumEnergy;
-    m.latencyS       = sumLatency;
-    m.tokensPerJoule = (sumEnergy>0.0 ? sumTokens / sumEnergy : 0.0);
+    double sumRouge = 0.0;
+    for (double r : rouges) sumRouge += r;
+    m.rougeL   = (count ? sumRouge / count : 0.0);
+    m.rougeLCI = stats::bootstrapMeanCI(rouges, B, mc.confidence, mc.seed);
+    if (perTrial) {
+        // Robust center and CI over whole-dataset passes; passes are
+        // rejected on latency and dropped from both series
+        auto kept       = stats::inliersMad(passLatency, mc.mad_threshold);
+        auto keptLat    = stats::select(passLatency, kept);
+        auto keptEnergy = stats::select(passEnergy, kept);
+        m.latencyS     = stats::median(keptLat);
+        m.energyTotalJ = stats::median(keptEnergy);
+        m.latencyCI    = stats::bootstrapMedianCI(keptLat, B, mc.confidence, mc.seed);
+        m.energyCI     = stats::bootstrapMedianCI(keptEnergy, B, mc.confidence, mc.seed);
+        rejected      += passLatency.size() - kept.size();
+    } else {
+        // Totals of per-example medians; CI by resampling each example's
+        // repetitions, so it reflects measurement noise rather than how
+        // documents differ (all configs share the documents)
+        m.latencyS     = passLatency.empty() ? 0.0 : passLatency[0];
+        m.energyTotalJ = passEnergy.empty() ? 0.0 : passEnergy[0];
+        m.latencyCI    = stats::bootstrapSumOfMediansCI(repLatencies, B, mc.confidence, mc.seed);
+        m.energyCI     = stats::bootstrapSumOfMediansCI(repEnergies, B, mc.confidence, mc.seed);
+    }
+    m.rejectedSamples = rejected;
+    m.tokensPerJoule = (m.energyTotalJ>0.0 ? sumTokens / m.energyTotalJ : 0.0);
+    m.avgNewTokens   = (count ? static_cast<double>(sumNewTokens) / count : 0.0);
+    m.avgTruncatedTokens = (count ? static_cast<double>(sumTruncated) / count : 0.0);
+    m.peakRssMB          = maxRssMB;
+    m.allocsPerExample   = (count ? static_cast<double>(sumAllocs) / count : 0.0);
+    m.allocsPerToken     = (sumNewTokens ? static_cast<double>(sumGenerateAllocs) / sumNewTokens : 0.0);
+    m.forwardAllocsPerToken = (sumNewTokens ? static_cast<double>(sumForwardAllocs) / sumNewTokens : 0.0);
+    m.loopAllocsPerToken    = (sumLoopSteps ? static_cast<double>(sumLoopAllocs) / sumLoopSteps : 0.0);
+
+    // Counter objectives, normalized per generated token and per example
+    auto scaled = [](const PerfCounts &c, double denom) {
+        if (denom <= 0.0) return PerfCounts::unavailable();
+        PerfCounts r;
+        r.cycles       = c.cycles / denom;
+        r.instructions = c.instructions / denom;
+        r.llcMisses    = c.llcMisses / denom;
+        r.branchMisses = c.branchMisses / denom;
+        return r;
+    };
+    m.perfTotal      = perf_ ? sumPerf : PerfCounts::unavailable();
+    m.perfPerToken   = scaled(m.perfTotal, static_cast<double>(sumNewTokens));
+    m.perfPerExample = scaled(m.perfTotal, static_cast<double>(count));
 
     return m;
 }
+
+void Evaluator::writeRunMetadata(const std::string &path) const
+{
+    const auto &mc = config_.measurement;
+    nlohmann::json meta;
+    meta["torch_threads"]         = at::get_num_threads();
+    meta["torch_interop_threads"] = at::get_num_interop_threads();
+    meta["hardware_concurrency"]  = std::thread::hardware_concurrency();
+    meta["cpu_governors"]         = utils::cpuGovernors();
+    meta["cpu_freq_khz"]          = utils::cpuFrequenciesKHz();
+    meta["perf_counters"]         = perf_ && perf_->available();
+    meta["perf_counter_scope"]    = "all_threads";  // intra-op pool included
+    meta["context_length"]        = config_.context_length;
+    meta["context_policy"]        = config_.context_policy;
+    meta["max_new_tokens"]        = config_.max_new_tokens;
+    meta["decoding"] = {
+        {"strategy",           config_.decoding.strategy},
+        {"temperature",        config_.decoding.temperature},
+        {"top_k",              config_.decoding.top_k},
+        {"top_p",              config_.decoding.top_p},
+        {"repetition_penalty", config_.decoding.repetition_penalty},
+        {"min_new_tokens",     config_.decoding.min_new_tokens},
+        {"seed",               config_.decoding.seed}
+    };
+    meta["measurement"] = {
+        {"warmup_examples",   mc.warmup_examples},
+        {"repetitions",       mc.repetitions},
+        {"repeat_mode",       mc.repeat_mode},
+        {"mad_threshold",     mc.mad_threshold},
+        {"bootstrap_samples", mc.bootstrap_samples},
+        {"confidence",        mc.confidence},
+        {"seed",              mc.seed}
+    };
+
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open metadata file: " + path);
+    }
+    out << meta.dump(2) << "\n";
+}
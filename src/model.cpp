@@ -1,8 +1,11 @@
 // ===== src/model.cpp =====
 #include "../header/model.hpp"
+#include "../header/trace.hpp"
+#include "../header/alloc_counter.hpp"
 #include <new>
 #include <torch/torch.h>
 #include <stdexcept>
+#include <algorithm>
 
 Model::Model(const std::string &model_path) {
     try {
@@ -10,39 +13,164 @@ Model::Model(const std::string &model_path) {
         module_ = torch::jit::load(model_path);
         // Move to GPU if available
         if (torch::cuda::is_available()) {
-            module_.to(torch::kCUDA);
+            device_ = torch::kCUDA;
+            module_.to(device_);
         }
         module_.eval();
+        forward_ = module_.get_method("forward");
+        cached_  = module_.find_method("forward_cached");
     } catch (const c10::Error &e) {
         throw std::runtime_error("Error loading the model from " + model_path + ": " + e.what());
     }
+    argmax_ = torch::empty({}, torch::TensorOptions().dtype(torch::kInt64).device(device_));
+    stack_.reserve(4);
 }
 
-std::vector<int64_t> Model::generate(
-    const std::vector<int64_t> &input_ids,
-    int max_new_tokens
+void Model::reserveTokens(int64_t len) {
+    if (tokens_.defined() && tokens_.size(1) >= len) return;
+    int64_t capacity = std::max<int64_t>(len, tokens_.defined() ? 2 * tokens_.size(1) : 0);
+    tokens_ = torch::empty({1, capacity},
+                           torch::TensorOptions().dtype(torch::kInt64).device(device_));
+}
+
+torch::Tensor Model::windowed(const torch::Tensor &ids) const {
+    int64_t len = ids.size(1);
+    if (context_window_ <= 0 || len <= context_window_) return ids;
+    return ids.narrow(1, len - context_window_, context_window_);
+}
+
+at::Tensor Model::forwardFull(const torch::Tensor &ids) {
+    EAPO_TRACE_SCOPE("forward");
+    stack_.clear();
+    stack_.emplace_back(windowed(ids));
+    const uint64_t a0 = alloc::count();
+    forward_->run(stack_);
+    forward_allocs_ += alloc::count() - a0;
+    // logits shape [1, seq_len, vocab_size]
+    return stack_.back().toTensor().select(1, -1); // last timestep
+}
+
+at::Tensor Model::forwardCached(const torch::Tensor &ids, CacheState &cache) {
+    EAPO_TRACE_SCOPE("forward");
+    stack_.clear();
+    stack_.emplace_back(ids);
+    stack_.emplace_back(std::move(cache.past));
+    const uint64_t a0 = alloc::count();
+    cached_->run(stack_);
+    forward_allocs_ += alloc::count() - a0;
+    auto out = stack_.back().toTuple();
+    cache.past    = out->elements()[1];
+    cache.length += ids.size(1);
+    return out->elements()[0].toTensor().select(1, -1);
+}
+
+at::Tensor Model::prefill(const torch::Tensor &ids, CacheState &cache) {
+    EAPO_TRACE_SCOPE("prefill");
+    cache.past   = torch::jit::IValue();
+    cache.length = 0;
+
+    int64_t len   = ids.size(1);
+    int64_t chunk = prefill_chunk_ > 0 ? prefill_chunk_ : len;
+    at::Tensor logits;
+    for (int64_t start = 0; start < len; start += chunk) {
+        logits = forwardCached(ids.narrow(1, start, std::min(chunk, len - start)), cache);
+    }
+    return logits;
+}
+
+at::Tensor Model::step(const torch::Tensor &ids,
+                       const torch::Tensor &next,
+                       CacheState &cache) {
+    if (!cached_) return forwardFull(ids);
+
+    // Cache full: re-prefill the most recent 3/4 of the window so the
+    // refill cost is amortized over the following steps
+    if (context_window_ > 0 && cache.length + 1 > context_window_) {
+        int64_t keep = std::max<int64_t>(1, context_window_ * 3 / 4);
+        return prefill(ids.narrow(1, ids.size(1) - keep, keep), cache);
+    }
+    return forwardCached(next, cache);
+}
+
+void Model::generate(
+    const std::vector<int> &input_ids,
+    StoppingCriteria &criteria,
+    Sampler &sampler,
+    GenerationResult &result
 ) {
-    // Prepare input tensor [1, seq_len]
-    auto options = torch::TensorOptions().dtype(torch::kInt64);
-    if (torch::cuda::is_available()) {
-        options = options.device(torch::kCUDA);
+    // Token buffer [1, prompt + budget]; the prompt is viewed in place
+    // (no int -> int64 vector copy) and converted by the buffer copy
+    const int64_t prompt_len = static_cast<int64_t>(input_ids.size());
+    reserveTokens(prompt_len + criteria.maxNewTokens());
+    torch::Tensor prompt = torch::from_blob(
+        const_cast<int *>(input_ids.data()), {1, prompt_len}, torch::kInt32);
+    tokens_.narrow(1, 0, prompt_len).copy_(prompt);
+    const bool on_cpu = tokens_.device().is_cpu();
+    int64_t *host_tokens = on_cpu ? tokens_.data_ptr<int64_t>() : nullptr;
+    int64_t len = prompt_len;
+
+    result.stop_reason      = StopReason::None;
+    result.prompt_tokens    = static_cast<int>(prompt_len);
+    result.truncated_tokens = 0;
+    criteria.reset();
+    forward_allocs_ = 0;
+    const bool greedy = sampler.isGreedy();
+    if (!greedy) sampler.observe(input_ids);
+
+    // Prefill: chunked through the cache when available
+    CacheState cache;
+    at::Tensor next_token_logits = cached_
+        ? prefill(windowed(tokens_.narrow(1, 0, len)), cache)
+        : forwardFull(tokens_.narrow(1, 0, len));
+
+    // Loop allocations exclude the prefill and the forward calls
+    const uint64_t loop_a0   = alloc::count();
+    const uint64_t loop_fwd0 = forward_allocs_;
+    int steps = 0;
+    while (true) {
+        ++steps;
+        EAPO_TRACE_SCOPE("decode_step");
+        // The stopping criteria run on the host, so one sync per step is
+        // inherent; on CPU this is a plain load from the argmax buffer
+        int64_t next_id;
+        if (greedy) {
+            at::argmax_out(argmax_, next_token_logits);
+            next_id = on_cpu ? *argmax_.data_ptr<int64_t>()
+                             : argmax_.item<int64_t>();
+        } else {
+            // Processed in place; a no-op view for CPU float logits
+            at::Tensor host = next_token_logits.to(torch::kCPU, torch::kFloat).contiguous();
+            next_id = sampler.next(host.data_ptr<float>(), host.numel(),
+                                   criteria.numGenerated());
+        }
+
+        // Check stopping criteria before extending the sequence
+        result.stop_reason = criteria.update(next_id);
+        if (result.stop_reason == StopReason::Eos) break;
+
+        // Append in place
+        if (on_cpu) {
+            host_tokens[len] = next_id;
+        } else {
+            tokens_.narrow(1, len, 1).fill_(next_id);
+        }
+        ++len;
+        if (result.stop_reason != StopReason::None) break;
+
+        next_token_logits = step(tokens_.narrow(1, 0, len),
+                                 tokens_.narrow(1, len - 1, 1), cache);
     }
-    torch::Tensor ids = torch::tensor(input_ids, options).unsqueeze(0);
-
-    std::vector<int64_t> output_ids = input_ids;
-    for (int i = 0; i < max_new_tokens; ++i) {
-        // Forward pass
-        std::vector<torch::IValue> inputs;
-        inputs.push_back(ids);
-        at::Tensor logits = module_.forward(inputs).toTensor();
-        // logits shape [1, seq_len, vocab_size]
-        at::Tensor next_token_logits = logits[0][-1]; // last timestep
-        int64_t next_id = next_token_logits.argmax().item<int64_t>();
-
-        // Append to outputs and input tensor
-        output_ids.push_back(next_id);
-        torch::Tensor next_tensor = torch::tensor({next_id}, options);
-        ids = torch::cat({ids, next_tensor.unsqueeze(0)}, /*dim=*/1);
+
+    result.loop_allocs    = (alloc::count() - loop_a0) - (forward_allocs_ - loop_fwd0);
+    result.loop_steps     = steps;
+    result.forward_allocs = forward_allocs_;
+
+    criteria.finish();
+    result.num_generated = criteria.numGenerated();
+    result.text.assign(criteria.text());
+    if (context_window_ > 0) {
+        result.truncated_tokens = std::max<int>(
+            0, static_cast<int>(len) - context_window_);
     }
-    return output_ids;
 }
+
@@ -0,0 +1,169 @@
+// ===== src/perf_counters.cpp =====
+#include "../header/perf_counters.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounts PerfCounts::unavailable() {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    PerfCounts c;
+    c.cycles = c.instructions = c.llcMisses = c.branchMisses = nan;
+    return c;
+}
+
+#ifdef __linux__
+
+static int openCounter(uint64_t config, int tid, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = config;
+    attr.disabled       = (group_fd == -1) ? 1 : 0;  // leader starts disabled
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP
+                        | PERF_FORMAT_TOTAL_TIME_ENABLED
+                        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = tid / cpu -1: that thread on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, 0));
+}
+
+static void closeGroup(int *fds, int n) {
+    for (int i = 0; i < n; ++i) {
+        if (fds[i] >= 0) close(fds[i]);
+        fds[i] = -1;
+    }
+}
+
+// Thread IDs of this process
+static std::vector<int> listThreads() {
+    std::vector<int> tids;
+    if (DIR *dir = opendir("/proc/self/task")) {
+        while (dirent *e = readdir(dir)) {
+            if (e->d_name[0] != '.') tids.push_back(std::atoi(e->d_name));
+        }
+        closedir(dir);
+    }
+    std::sort(tids.begin(), tids.end());
+    return tids;
+}
+
+bool PerfCounterGroup::open(int tid, ThreadGroup &group) {
+    // Order matches PerfCounts fields
+    const uint64_t configs[kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    group.tid = tid;
+    std::fill(group.fds, group.fds + kNumCounters, -1);
+    for (int i = 0; i < kNumCounters; ++i) {
+        int fd = openCounter(configs[i], tid, i == 0 ? -1 : group.fds[0]);
+        if (fd < 0) {
+            reason_ = std::string("perf_event_open failed: ") + std::strerror(errno);
+            closeGroup(group.fds, i);
+            return false;
+        }
+        group.fds[i] = fd;
+    }
+    return true;
+}
+
+PerfCounterGroup::PerfCounterGroup() {
+    ThreadGroup self;
+    if (!open(static_cast<int>(syscall(SYS_gettid)), self)) return;
+    threads_.push_back(self);
+    leader_fd_ = self.fds[0];
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    for (auto &g : threads_) closeGroup(g.fds, kNumCounters);
+}
+
+void PerfCounterGroup::sync() {
+    if (!available()) return;
+    const std::vector<int> live = listThreads();
+
+    // Drop groups of threads that have exited (their work since the
+    // last stop() was already read)
+    auto gone = std::remove_if(threads_.begin(), threads_.end(), [&](ThreadGroup &g) {
+        if (std::binary_search(live.begin(), live.end(), g.tid)) return false;
+        closeGroup(g.fds, kNumCounters);
+        return true;
+    });
+    threads_.erase(gone, threads_.end());
+
+    complete_ = true;
+    for (int tid : live) {
+        bool known = std::any_of(threads_.begin(), threads_.end(),
+                                 [tid](const ThreadGroup &g) { return g.tid == tid; });
+        if (known) continue;
+        ThreadGroup g;
+        if (open(tid, g)) {
+            threads_.push_back(g);
+        } else if (errno != ESRCH) {
+            complete_ = false;  // alive but uncountable: totals would be partial
+        }
+    }
+}
+
+void PerfCounterGroup::start() {
+    if (!available()) return;
+    for (const auto &g : threads_) {
+        ioctl(g.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(g.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounts PerfCounterGroup::stop() {
+    if (!available()) return PerfCounts::unavailable();
+    for (const auto &g : threads_) {
+        ioctl(g.fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+    if (!complete_) return PerfCounts::unavailable();
+
+    PerfCounts c;
+    for (const auto &g : threads_) {
+        // Layout: nr, time_enabled, time_running, value[nr]
+        uint64_t buf[3 + kNumCounters];
+        ssize_t n = read(g.fds[0], buf, sizeof(buf));
+        if (n != static_cast<ssize_t>(sizeof(buf)) || buf[0] != kNumCounters) {
+            return PerfCounts::unavailable();
+        }
+        uint64_t enabled = buf[1], running = buf[2];
+        if (running == 0) {
+            if (enabled == 0) continue;     // thread never scheduled
+            return PerfCounts::unavailable();  // scheduled but never counted
+        }
+        double scale = static_cast<double>(enabled) / running;
+
+        c.cycles       += buf[3] * scale;
+        c.instructions += buf[4] * scale;
+        c.llcMisses    += buf[5] * scale;
+        c.branchMisses += buf[6] * scale;
+    }
+    return c;
+}
+
+#else
+
+PerfCounterGroup::PerfCounterGroup() : reason_("perf counters require Linux") {}
+PerfCounterGroup::~PerfCounterGroup() {}
+bool PerfCounterGroup::open(int, ThreadGroup &) { return false; }
+void PerfCounterGroup::sync() {}
+void PerfCounterGroup::start() {}
+PerfCounts PerfCounterGroup::stop() { return PerfCounts::unavailable(); }
+
+#endif
@@ -4,12 +4,14 @@
 #include "../header/tokenizer.hpp"
 #include "../header/model.hpp"
 #include "../header/evaluator.hpp"
+#include "../header/trace.hpp"
 
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <iostream>
 #include <vector>
 #include <map>
+#include <utility>
 
 int main(int argc, char** argv) {
     if (argc != 2) {
@@ -19,25 +21,30 @@ int main(int argc, char** argv) {
     // Load configuration
     Config cfg = Config::load(argv[1]);
 
-    // Build trial list (grid search)
+    // Search axes: the four prompt axes, then any decoding parameters
+    std::vector<std::pair<std::string, std::vector<std::string>>> axes;
+    for (const char *key : {"style", "reasoning", "format", "brevity"}) {
+        axes.emplace_back(key, cfg.prompt_space.at(key));
+    }
+    for (const auto &kv : cfg.decoding_space) {
+        if (!kv.second.empty()) axes.push_back(kv);
+    }
+
+    // Build trial list (grid search, last axis varies fastest)
     std::vector<std::map<std::string, std::string>> trials;
-    for (const auto &style : cfg.prompt_space.at("style")) {
-        for (const auto &reasoning : cfg.prompt_space.at("reasoning")) {
-            for (const auto &fmt : cfg.prompt_space.at("format")) {
-                for (const auto &brev : cfg.prompt_space.at("brevity")) {
-                    trials.push_back({
-                        {"style",     style},
-                        {"reasoning", reasoning},
-                        {"format",    fmt},
-                        {"brevity",   brev}
-                    });
-                    if (trials.size() >= (size_t)cfg.num_trials) break;
-                }
-                if (trials.size() >= (size_t)cfg.num_trials) break;
-            }
-            if (trials.size() >= (size_t)cfg.num_trials) break;
+    std::vector<size_t> pos(axes.size(), 0);
+    bool done = false;
+    for (const auto &axis : axes) done = done || axis.second.empty();
+    while (!done && trials.size() < (size_t)cfg.num_trials) {
+        std::map<std::string, std::string> trial;
+        for (size_t a = 0; a < axes.size(); ++a) {
+            trial[axes[a].first] = axes[a].second[pos[a]];
         }
-        if (trials.size() >= (size_t)cfg.num_trials) break;
+        trials.push_back(std::move(trial));
+
+        size_t a = axes.size();
+        while (a > 0 && ++pos[a - 1] == axes[a - 1].second.size()) pos[--a] = 0;
+        done = (a == 0);
     }
 
     // Open output CSV
@@ -46,32 +53,73 @@ int main(int argc, char** argv) {
         std::cerr << "Failed to open output: " << cfg.results_dir << "/trials.csv\n";
         return 1;
     }
-    csvOut << "style,reasoning,format,brevity,rougeL,energy_J,latency_s,tpj\n";
+    for (const auto &axis : axes) csvOut << axis.first << ',';
+    csvOut << "rougeL,energy_J,latency_s,tpj,avg_new_tokens,"
+              "cycles_per_token,instructions_per_token,llc_misses_per_token,branch_misses_per_token,"
+              "cycles_per_example,instructions_per_example,llc_misses_per_example,branch_misses_per_example,"
+              "avg_truncated_tokens,peak_rss_MB,"
+              "rougeL_ci_low,rougeL_ci_high,energy_J_ci_low,energy_J_ci_high,"
+              "latency_s_ci_low,latency_s_ci_high,rejected_samples,"
+              "allocs_per_example,allocs_per_token,"
+              "forward_allocs_per_token,loop_allocs_per_token\n";
 
     // Initialize evaluator
     Tokenizer   tokenizer(cfg.tokenizer_path);
     Model       model(cfg.model_path);
     Evaluator   evaluator(tokenizer, model, cfg);
+    evaluator.writeRunMetadata(cfg.results_dir + "/run_metadata.json");
 
     // Loop over trials
-    for (const auto &pcfg : trials) {
+    for (size_t t = 0; t < trials.size(); ++t) {
+        const auto &pcfg = trials[t];
         // Convert prompt config to JSON string
         nlohmann::json jcfg = pcfg;
         std::string promptJson = jcfg.dump();
 
-        // Evaluate summary metrics for this prompt
-        Evaluator::SummaryMetrics summary = evaluator.evaluateSummary(promptJson);
+        // Evaluate summary metrics for this prompt; on failure stop with
+        // the rows written so far intact
+        Evaluator::SummaryMetrics summary;
+        try {
+            summary = evaluator.evaluateSummary(promptJson);
+        } catch (const std::exception &e) {
+            std::cerr << "Trial " << t << " (" << promptJson << ") failed: "
+                      << e.what() << "\n";
+            return 1;
+        }
 
         // Write a row
+        for (const auto &axis : axes) csvOut << pcfg.at(axis.first) << ',';
         csvOut
-            << pcfg.at("style")           << ','
-            << pcfg.at("reasoning")       << ','
-            << pcfg.at("format")          << ','
-            << pcfg.at("brevity")         << ','
             << summary.rougeL             << ','
             << summary.energyTotalJ       << ','
             << summary.latencyS           << ','
-            << summary.tokensPerJoule     << '\n';
+            << summary.tokensPerJoule     << ','
+            << summary.avgNewTokens       << ','
+            << summary.perfPerToken.cycles         << ','
+            << summary.perfPerToken.instructions   << ','
+            << summary.perfPerToken.llcMisses      << ','
+            << summary.perfPerToken.branchMisses   << ','
+            << summary.perfPerExample.cycles       << ','
+            << summary.perfPerExample.instructions << ','
+            << summary.perfPerExample.llcMisses    << ','
+            << summary.perfPerExample.branchMisses << ','
+            << summary.avgTruncatedTokens          << ','
+            << summary.peakRssMB                   << ','
+            << summary.rougeLCI.low                << ','
+            << summary.rougeLCI.high               << ','
+            << summary.energyCI.low                << ','
+            << summary.energyCI.high               << ','
+            << summary.latencyCI.low               << ','
+            << summary.latencyCI.high              << ','
+            << summary.rejectedSamples             << ','
+            << summary.allocsPerExample            << ','
+            << summary.allocsPerToken              << ','
+            << summary.forwardAllocsPerToken       << ','
+            << summary.loopAllocsPerToken          << '\n';
+
+        // Per-stage timings for this trial (no-op unless built with EAPO_TRACE)
+        trace::exportChrome(cfg.results_dir + "/trace_trial_" + std::to_string(t) + ".json");
+        trace::clear();
     }
 
     csvOut.close();
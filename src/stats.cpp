@@ -0,0 +1,132 @@
+// ===== src/stats.cpp =====
+#include "../header/stats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace stats {
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double hi = values[mid];
+    if (values.size() % 2 == 1) return hi;
+    double lo = *std::max_element(values.begin(), values.begin() + mid);
+    return (lo + hi) / 2.0;
+}
+
+double mad(const std::vector<double> &values) {
+    double med = median(values);
+    std::vector<double> dev;
+    dev.reserve(values.size());
+    for (double v : values) dev.push_back(std::fabs(v - med));
+    return median(std::move(dev));
+}
+
+std::vector<size_t> inliersMad(const std::vector<double> &values, double threshold) {
+    std::vector<size_t> kept;
+    kept.reserve(values.size());
+    double m = mad(values);
+    if (threshold <= 0.0 || values.size() < 3 || m == 0.0) {
+        for (size_t i = 0; i < values.size(); ++i) kept.push_back(i);
+        return kept;
+    }
+
+    double med = median(values);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (0.6745 * std::fabs(values[i] - med) / m <= threshold) kept.push_back(i);
+    }
+    return kept;
+}
+
+std::vector<double> select(const std::vector<double> &values,
+                           const std::vector<size_t> &indices) {
+    std::vector<double> out;
+    out.reserve(indices.size());
+    for (size_t i : indices) out.push_back(values[i]);
+    return out;
+}
+
+// Central `confidence` interval of a bootstrap distribution
+static Interval percentileInterval(std::vector<double> &dist, double confidence) {
+    std::sort(dist.begin(), dist.end());
+    double alpha = (1.0 - confidence) / 2.0;
+    auto at = [&](double q) {
+        size_t idx = static_cast<size_t>(q * (dist.size() - 1) + 0.5);
+        return dist[std::min(idx, dist.size() - 1)];
+    };
+    Interval ci;
+    ci.low  = at(alpha);
+    ci.high = at(1.0 - alpha);
+    return ci;
+}
+
+// Bootstrap distribution of sum(resample) / divisor
+static Interval bootstrap(const std::vector<double> &values,
+                          size_t resamples, double confidence,
+                          uint64_t seed, double divisor) {
+    Interval ci;
+    if (values.empty()) return ci;
+    if (values.size() == 1 || resamples == 0) {
+        ci.low = ci.high = values[0] * values.size() / divisor;
+        return ci;
+    }
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, values.size() - 1);
+    std::vector<double> dist(resamples);
+    for (size_t r = 0; r < resamples; ++r) {
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i) sum += values[pick(rng)];
+        dist[r] = sum / divisor;
+    }
+    return percentileInterval(dist, confidence);
+}
+
+Interval bootstrapMeanCI(const std::vector<double> &values,
+                         size_t resamples, double confidence, uint64_t seed) {
+    return bootstrap(values, resamples, confidence, seed,
+                     static_cast<double>(std::max<size_t>(values.size(), 1)));
+}
+
+Interval bootstrapMedianCI(const std::vector<double> &values,
+                           size_t resamples, double confidence, uint64_t seed) {
+    return bootstrapSumOfMediansCI({values}, resamples, confidence, seed);
+}
+
+Interval bootstrapSumOfMediansCI(const std::vector<std::vector<double>> &groups,
+                                 size_t resamples, double confidence, uint64_t seed) {
+    double point = 0.0;
+    bool spread = false;
+    for (const auto &g : groups) {
+        point += median(g);
+        spread = spread || g.size() > 1;
+    }
+    if (!spread || resamples == 0) return Interval{point, point};
+
+    std::mt19937_64 rng(seed);
+    std::vector<double> dist(resamples), sample;
+    for (size_t r = 0; r < resamples; ++r) {
+        double sum = 0.0;
+        for (const auto &g : groups) {
+            if (g.size() <= 1) {
+                sum += median(g);
+                continue;
+            }
+            std::uniform_int_distribution<size_t> pick(0, g.size() - 1);
+            sample.resize(g.size());
+            for (double &v : sample) v = g[pick(rng)];
+            sum += median(sample);
+        }
+        dist[r] = sum;
+    }
+    Interval ci = percentileInterval(dist, confidence);
+    // Keep the reported statistic inside its own interval (the percentile
+    // bootstrap of a median can miss it by one order statistic)
+    ci.low  = std::min(ci.low, point);
+    ci.high = std::max(ci.high, point);
+    return ci;
+}
+
+} // namespace stats
@@ -0,0 +1,219 @@
+// ===== src/stopping.cpp =====
+#include "../header/stopping.hpp"
+#include "../header/trace.hpp"
+#include "../header/utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+const char *stopReasonName(StopReason reason) {
+    switch (reason) {
+        case StopReason::None:          return "none";
+        case StopReason::Eos:           return "eos";
+        case StopReason::StopString:    return "stop_string";
+        case StopReason::SentenceCount: return "sentence_count";
+        case StopReason::WordCount:     return "word_count";
+        case StopReason::TokenBudget:   return "token_budget";
+    }
+    return "unknown";
+}
+
+// ---- IncrementalDetokenizer ----
+
+void IncrementalDetokenizer::decodeRange(size_t begin, size_t end, std::string &out) {
+    out.clear();
+    if (begin >= end) return;
+    window_.assign(ids_.begin() + begin, ids_.begin() + end);
+    tokenizer_.decode(window_, out);
+}
+
+size_t IncrementalDetokenizer::push(int id) {
+    EAPO_TRACE_SCOPE("detokenize");
+    ids_.push_back(id);
+
+    // Decode the same window with and without the pending pieces; the
+    // difference is the newly visible text.
+    decodeRange(prefix_offset_, read_offset_, prefix_text_);
+    decodeRange(prefix_offset_, ids_.size(), new_text_);
+
+    // Hold back incomplete UTF-8 sequences (decoded as U+FFFD)
+    static const char kReplacement[] = "\xEF\xBF\xBD";
+    const size_t kReplacementLen = sizeof(kReplacement) - 1;
+    bool incomplete = new_text_.size() >= kReplacementLen &&
+        new_text_.compare(new_text_.size() - kReplacementLen,
+                          kReplacementLen, kReplacement) == 0;
+
+    if (new_text_.size() <= prefix_text_.size() || incomplete) {
+        return 0;
+    }
+
+    size_t appended = new_text_.size() - prefix_text_.size();
+    text_.append(new_text_, prefix_text_.size(), appended);
+    prefix_offset_ = read_offset_;
+    read_offset_   = ids_.size();
+    return appended;
+}
+
+size_t IncrementalDetokenizer::finish() {
+    if (read_offset_ >= ids_.size()) return 0;
+    decodeRange(prefix_offset_, read_offset_, prefix_text_);
+    decodeRange(prefix_offset_, ids_.size(), new_text_);
+
+    size_t appended = 0;
+    if (new_text_.size() > prefix_text_.size()) {
+        appended = new_text_.size() - prefix_text_.size();
+        text_.append(new_text_, prefix_text_.size(), appended);
+    }
+    prefix_offset_ = read_offset_ = ids_.size();
+    return appended;
+}
+
+void IncrementalDetokenizer::reset() {
+    ids_.clear();
+    prefix_offset_ = 0;
+    read_offset_   = 0;
+    text_.clear();
+}
+
+// ---- StoppingCriteria ----
+
+// Parse "<N><suffix>" or "<prefix><N>"; returns 0 when the value does not match
+static int parseLimit(const std::string &value,
+                      const std::string &prefix,
+                      const std::string &suffix) {
+    if (value.size() <= prefix.size() + suffix.size()) return 0;
+    if (value.compare(0, prefix.size(), prefix) != 0) return 0;
+    if (value.compare(value.size() - suffix.size(), suffix.size(), suffix) != 0) return 0;
+    std::string digits = value.substr(prefix.size(),
+                                      value.size() - prefix.size() - suffix.size());
+    if (digits.empty() ||
+        !std::all_of(digits.begin(), digits.end(),
+                     [](unsigned char c) { return std::isdigit(c); })) return 0;
+    return std::stoi(digits);
+}
+
+StoppingCriteria::Spec
+StoppingCriteria::fromPromptConfig(const std::map<std::string, std::string> &cfg,
+                                   const Spec &base) {
+    Spec spec = base;
+    auto get = [&](const std::string &key) {
+        auto it = cfg.find(key);
+        return it != cfg.end() ? it->second : std::string();
+    };
+
+    if (!get("max_new_tokens").empty()) {
+        spec.max_new_tokens = utils::parseInt("max_new_tokens", get("max_new_tokens"));
+    }
+
+    // Brevity constraints: "1sent", "3sent", "word50", "token50"
+    std::string brevity = get("brevity");
+    if (int n = parseLimit(brevity, "", "sent")) {
+        spec.max_sentences = n;
+    } else if (int n = parseLimit(brevity, "word", "")) {
+        spec.max_words = n;
+    } else if (int n = parseLimit(brevity, "token", "")) {
+        spec.max_new_tokens = std::min(spec.max_new_tokens, n);
+    }
+
+    if (!get("stop").empty()) {
+        spec.stop_strings.push_back(get("stop"));
+    }
+    return spec;
+}
+
+StoppingCriteria::StoppingCriteria(const Tokenizer &tokenizer, Spec spec)
+    : spec_(std::move(spec))
+    , detok_(tokenizer)
+{
+    if (spec_.max_new_tokens <= 0) {
+        throw std::invalid_argument("max_new_tokens must be positive");
+    }
+    for (const auto &s : spec_.stop_strings) {
+        max_stop_len_ = std::max(max_stop_len_, s.size());
+    }
+}
+
+void StoppingCriteria::reset() {
+    detok_.reset();
+    num_generated_ = 0;
+    scan_pos_      = 0;
+    sentences_     = 0;
+    words_         = 0;
+    in_word_       = false;
+    cut_           = false;
+}
+
+void StoppingCriteria::finish() {
+    if (!cut_) detok_.finish();
+}
+
+StopReason StoppingCriteria::update(int64_t token_id) {
+    if (std::find(spec_.eos_ids.begin(), spec_.eos_ids.end(), token_id)
+            != spec_.eos_ids.end()) {
+        return StopReason::Eos;
+    }
+    ++num_generated_;
+
+    // Always detokenize so the caller gets the text without a final decode
+    size_t appended = detok_.push(static_cast<int>(token_id));
+    if (spec_.needsText()) {
+        StopReason reason = checkText(appended);
+        if (reason != StopReason::None) return reason;
+    }
+
+    if (num_generated_ >= spec_.max_new_tokens) {
+        return StopReason::TokenBudget;
+    }
+    return StopReason::None;
+}
+
+StopReason StoppingCriteria::checkText(size_t appended) {
+    if (appended == 0) return StopReason::None;
+    const std::string &text = detok_.text();
+
+    // Stop strings may straddle the previous chunk
+    if (max_stop_len_ > 0) {
+        size_t from = text.size() - appended;
+        from = (from >= max_stop_len_ - 1) ? from - (max_stop_len_ - 1) : 0;
+        size_t best = std::string::npos;
+        for (const auto &s : spec_.stop_strings) {
+            size_t pos = text.find(s, from);
+            if (pos < best) best = pos;
+        }
+        if (best != std::string::npos) {
+            detok_.truncate(best);
+            cut_ = true;
+            return StopReason::StopString;
+        }
+    }
+
+    // A sentence ends at [.!?] followed by whitespace; a word ends at
+    // whitespace. Cut the text right before the boundary that hit a limit.
+    for (; scan_pos_ < text.size(); ++scan_pos_) {
+        char c = text[scan_pos_];
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            in_word_ = true;
+            continue;
+        }
+        if (!in_word_) continue;
+        in_word_ = false;
+
+        char prev = text[scan_pos_ - 1];
+        if (prev == '.' || prev == '!' || prev == '?') {
+            ++sentences_;
+            if (spec_.max_sentences > 0 && sentences_ >= spec_.max_sentences) {
+                detok_.truncate(scan_pos_);
+                cut_ = true;
+                return StopReason::SentenceCount;
+            }
+        }
+        ++words_;
+        if (spec_.max_words > 0 && words_ >= spec_.max_words) {
+            detok_.truncate(scan_pos_);
+            cut_ = true;
+            return StopReason::WordCount;
+        }
+    }
+    return StopReason::None;
+}
@@ -0,0 +1,130 @@
+// ===== src/trace.cpp =====
+#include "../header/trace.hpp"
+
+#ifdef EAPO_TRACE
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+struct Event {
+    const char *name;
+    int64_t begin_ns;
+    int64_t end_ns;
+};
+
+// Per-thread event storage. Capacity is fixed up front so recording never
+// reallocates; events past capacity are counted and dropped.
+struct ThreadBuffer {
+    static constexpr size_t kCapacity = 1 << 16;
+    explicit ThreadBuffer(int tid_) : tid(tid_) { events.reserve(kCapacity); }
+    int tid;
+    std::vector<Event> events;
+    size_t dropped = 0;
+};
+
+// Registry of every thread's buffer; locked only on first use per thread
+// and when exporting/clearing.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &registry() {
+    static Registry r;
+    return r;
+}
+
+ThreadBuffer &localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buf = [] {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto b = std::make_shared<ThreadBuffer>(static_cast<int>(r.buffers.size()) + 1);
+        r.buffers.push_back(b);
+        return b;
+    }();
+    return *buf;
+}
+
+// Minimal JSON string escaping for event names
+std::string escapeJson(const char *s) {
+    std::string out;
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') out += '\\';
+        out += *s;
+    }
+    return out;
+}
+
+} // namespace
+
+int64_t nowNs() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+
+void record(const char *name, int64_t begin_ns, int64_t end_ns) {
+    ThreadBuffer &buf = localBuffer();
+    if (buf.events.size() < ThreadBuffer::kCapacity) {
+        buf.events.push_back({name, begin_ns, end_ns});
+    } else {
+        ++buf.dropped;
+    }
+}
+
+bool exportChrome(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // Timestamps relative to the earliest event, in microseconds
+    int64_t origin = INT64_MAX;
+    for (const auto &b : r.buffers) {
+        for (const auto &e : b->events) origin = std::min(origin, e.begin_ns);
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &b : r.buffers) {
+        for (const auto &e : b->events) {
+            if (!first) out << ',';
+            first = false;
+            out << "\n{\"name\":\"" << escapeJson(e.name) << "\""
+                << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+                << ",\"ts\":" << (e.begin_ns - origin) / 1000.0
+                << ",\"dur\":" << (e.end_ns - e.begin_ns) / 1000.0 << '}';
+        }
+        if (b->dropped > 0) {
+            if (!first) out << ',';
+            first = false;
+            out << "\n{\"name\":\"dropped_events\",\"ph\":\"C\",\"pid\":1"
+                << ",\"tid\":" << b->tid << ",\"ts\":0"
+                << ",\"args\":{\"count\":" << b->dropped << "}}";
+        }
+    }
+    out << "\n]}\n";
+    return true;
+}
+
+void clear() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto &b : r.buffers) {
+        b->events.clear();
+        b->dropped = 0;
+    }
+}
+
+} // namespace trace
+
+#endif // EAPO_TRACE
@@ -2,9 +2,43 @@
 #include "../header/utils.hpp"
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 
 namespace utils {
 
+template <typename T, typename Parse>
+static T parseNumber(const std::string &key, const std::string &value, Parse parse) {
+    size_t used = 0;
+    T result{};
+    try {
+        result = parse(value, &used);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) {
+        throw std::invalid_argument("Invalid value for " + key + ": '" + value + "'");
+    }
+    return result;
+}
+
+int parseInt(const std::string &key, const std::string &value) {
+    return parseNumber<int>(key, value,
+        [](const std::string &s, size_t *n) { return std::stoi(s, n); });
+}
+
+float parseFloat(const std::string &key, const std::string &value) {
+    return parseNumber<float>(key, value,
+        [](const std::string &s, size_t *n) { return std::stof(s, n); });
+}
+
+uint64_t parseUint64(const std::string &key, const std::string &value) {
+    return parseNumber<uint64_t>(key, value, [](const std::string &s, size_t *n) {
+        // stoull wraps negative input around instead of failing
+        if (!s.empty() && s[0] == '-') throw std::invalid_argument(s);
+        return static_cast<uint64_t>(std::stoull(s, n));
+    });
+}
+
 std::vector<std::string> readLines(const std::string &filepath) {
     std::vector<std::string> lines;
     std::ifstream in(filepath);
@@ -39,4 +73,50 @@ void writeCsv(const std::string &filepath,
     }
 }
 
+size_t peakRssBytes() {
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            std::istringstream iss(line.substr(6));
+            size_t kb = 0;
+            iss >> kb;
+            return kb * 1024;
+        }
+    }
+    return 0;
+}
+
+bool resetPeakRss() {
+    // "5" resets the peak RSS counter (Linux >= 4.0)
+    std::ofstream out("/proc/self/clear_refs");
+    if (!out) return false;
+    out << "5";
+    return static_cast<bool>(out.flush());
+}
+
+std::vector<std::string> cpuGovernors() {
+    std::vector<std::string> out;
+    for (int cpu = 0; ; ++cpu) {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu)
+                         + "/cpufreq/scaling_governor");
+        std::string gov;
+        if (!in || !(in >> gov)) break;
+        out.push_back(gov);
+    }
+    return out;
+}
+
+std::vector<long> cpuFrequenciesKHz() {
+    std::vector<long> out;
+    for (int cpu = 0; ; ++cpu) {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu)
+                         + "/cpufreq/scaling_cur_freq");
+        long khz = 0;
+        if (!in || !(in >> khz)) break;
+        out.push_back(khz);
+    }
+    return out;
+}
+
 } // namespace utils
\ No newline at end of file